@@ -0,0 +1,591 @@
+// TanhSaturator-bench - headless DSP micro-benchmarks
+//
+// Drives the saturator, the lowpass and the full effect without a host or GUI
+// and reports ns per stereo sample frame and throughput as a multiple of real time.
+// The channels/ cases run the full effect at each supported channel count and
+// report ns per sample of one channel, which should fall as channels are added.
+//
+// Usage:
+//   TanhSaturator-bench [--out results.json] [--compare baseline.json]
+//                       [--threshold percent] [--seconds s] [--repeats n] [--filter text]
+//   TanhSaturator-bench --instances n
+//   TanhSaturator-bench --startup
+//   TanhSaturator-bench --check [--golden dir [--update-golden]] [--filter text]
+//
+// --compare fails (exit code 1) when any case present in both files is slower
+// than the baseline by more than --threshold percent (default 10). Cases missing
+// from the baseline are listed and counted but don't fail the run; a baseline
+// that shares no case with this run, or holds no cases at all, fails with code 2.
+//
+// --instances creates n processors, as a large session would, and reports the
+// construction time and resident memory per instance instead of running the cases.
+//
+// --startup measures time to first process for sessions of 1, 100 and 500
+// instances: how long until every instance has been created, prepared and has
+// processed its first vector. Time to first frame needs a window and isn't measured
+// yet. The editor's drawing properties are built once per process; its fonts belong
+// to each view's drawing context and are still loaded in initializeResources().
+//
+// --check runs the golden-render and fast-path equivalence checks of
+// TanhSaturator-check.cpp instead, and exits with code 1 if any fails.
+
+#include "TanhSaturator.h"
+#include "TanhSaturator-check.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace {
+
+constexpr int kVectorSize = static_cast<int>(ml::kFloatsPerDSPVector);
+
+struct Options {
+  std::string outPath;
+  std::string comparePath;
+  std::string filter;
+  double thresholdPercent = 10.0;
+  double audioSeconds = 2.0;
+  int repeats = 5;
+  int instances = 0;
+  bool startup = false;
+  bool check = false;
+  CheckOptions checkOptions;
+};
+
+struct Result {
+  std::string name;
+  double sampleRate = 0.0;
+  double nsPerSample = 0.0;     // fastest repeat, per stereo frame
+  double nsPerSampleMedian = 0.0;
+  double realtimeFactor = 0.0;  // audio seconds processed per wall second
+};
+
+// Exposes parameter setting, which CLAPSignalProcessor keeps protected
+class BenchSaturator : public TanhSaturator {
+public:
+  void setParam(const char* name, float value) { _params.setFromRealValue(ml::Path(name), value); }
+};
+
+using ParamSettings = std::vector<std::pair<const char*, float>>;
+
+// Test signal: a few sines plus noise, with peaks around 0 dBFS
+class TestSignal {
+public:
+  explicit TestSignal(float sampleRate) {
+    uint32_t seed = 0x12345678u;
+    for (auto& v : _vectors) {
+      for (size_t c = 0; c < 2; ++c) {
+        for (int i = 0; i < kVectorSize; ++i) {
+          float t = static_cast<float>(_frame + i) / sampleRate;
+          seed = seed * 1664525u + 1013904223u;
+          float noise = static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+          v.row(static_cast<int>(c))[i] = 0.5f * std::sin(2.0f * ml::kPi * 110.0f * t + c) +
+                                          0.3f * std::sin(2.0f * ml::kPi * 1870.0f * t) + 0.1f * noise;
+        }
+      }
+      _frame += kVectorSize;
+    }
+  }
+
+  const ml::DSPVectorArray<2>& operator[](int i) const { return _vectors[i % kNumVectors]; }
+
+private:
+  static constexpr int kNumVectors = 64;
+  ml::DSPVectorArray<2> _vectors[kNumVectors];
+  int _frame = 0;
+};
+
+// Times processVector(i) for audioSeconds of audio, repeats times
+Result measure(const std::string& name, float sampleRate, const Options& options,
+               const std::function<void(int)>& processVector) {
+  const int nVectors = std::max(1, static_cast<int>(options.audioSeconds * sampleRate) / kVectorSize);
+
+  // Warm up caches, tables and branch predictors
+  for (int i = 0; i < std::min(nVectors, 256); ++i) processVector(i);
+
+  std::vector<double> times;
+  for (int r = 0; r < options.repeats; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nVectors; ++i) processVector(i);
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  std::sort(times.begin(), times.end());
+
+  const double samples = static_cast<double>(nVectors) * kVectorSize;
+  Result result;
+  result.name = name;
+  result.sampleRate = sampleRate;
+  result.nsPerSample = times.front() / samples;
+  result.nsPerSampleMedian = times[times.size() / 2] / samples;
+  result.realtimeFactor = 1e9 / (result.nsPerSample * sampleRate);
+  return result;
+}
+
+// Prevents the optimizer from discarding the processed audio
+volatile float gSink = 0.0f;
+
+// ---------------------------------------------------------------------------
+// Cases
+
+// The saturation stage as run by processTanhSaturation: ADAA and the tanh kernel,
+// inside the oversampler when enabled.
+void benchSaturation(const Options& options, std::vector<Result>& results) {
+  const char* qualityNames[] = { "draft", "standard", "high", "reference" };
+  const char* adaaNames[] = { "off", "adaa1", "adaa2" };
+  const char* modeNames[] = { "linear", "minimum" };
+  const float sampleRate = 48000.0f;
+  TestSignal signal(sampleRate);
+
+  for (int quality = 0; quality < 4; ++quality) {
+    for (int adaa = 0; adaa < 3; ++adaa) {
+      for (int factorLog2 = 0; factorLog2 <= dsp::Oversampler<2>::kMaxFactorLog2; ++factorLog2) {
+        for (int mode = 0; mode < (factorLog2 > 0 ? 2 : 1); ++mode) {
+          std::string name = std::string("saturation/") + qualityNames[quality] + "/" + adaaNames[adaa] +
+                             "/os" + std::to_string(1 << factorLog2) + (factorLog2 > 0 ? std::string("/") + modeNames[mode] : "");
+          if (name.find(options.filter) == std::string::npos) continue;
+
+          dsp::TanhAdaa<2> tanhAdaa;
+          dsp::Oversampler<2> oversampler;
+          tanhAdaa.setOrder(static_cast<dsp::AdaaOrder>(adaa));
+          oversampler.setFactor(factorLog2);
+          oversampler.setMode(static_cast<dsp::OversamplingMode>(mode));
+          auto tanhQuality = static_cast<dsp::TanhQuality>(quality);
+
+          results.push_back(measure(name, sampleRate, options, [&](int i) {
+            ml::DSPVectorArray<2> samples = signal[i] * ml::DSPVectorArray<2>(2.2f);
+            if (oversampler.getFactor() == 1) {
+              samples = tanhAdaa.process(samples, tanhQuality);
+            } else {
+              oversampler.upsample(samples);
+              for (int r = 0; r < oversampler.getFactor(); ++r) {
+                oversampler.pack(r) = tanhAdaa.process(oversampler.pack(r), tanhQuality);
+              }
+              oversampler.downsample(samples);
+            }
+            gSink = gSink + samples[0];
+          }));
+        }
+      }
+    }
+  }
+}
+
+// The post-saturation lowpass, with fixed coefficients, ramping g and k, and ramping
+// through the shared coefficient table as the plugin does. The -f64 cases run the
+// recursion in double and the -nonlinear cases saturate the feedback, for
+// comparison with the default linear float path.
+void benchLowpass(const Options& options, std::vector<Result>& results) {
+  for (float sampleRate : { 48000.0f, 96000.0f }) {
+    TestSignal signal(sampleRate);
+    auto table = dsp::SvfCoeffTable::acquire(sampleRate);
+    for (const char* mode : { "static", "ramping", "ramping-table", "static-f64", "ramping-table-f64",
+                              "static-nonlinear", "ramping-table-nonlinear" }) {
+      std::string name = std::string("lowpass/") + mode + "/" + std::to_string(static_cast<int>(sampleRate));
+      if (name.find(options.filter) == std::string::npos) continue;
+      const bool ramping = std::strncmp(mode, "static", 6) != 0;
+      const bool useTable = std::strncmp(mode, "ramping-table", 13) == 0;
+      const bool f64 = std::strstr(mode, "-f64") != nullptr;
+      const bool nonlinear = std::strstr(mode, "-nonlinear") != nullptr;
+
+      dsp::SvfLowpass<2> lowpass;
+      lowpass.setCoeffs(dsp::SvfCoeffs::make(1500.0f / sampleRate, 1.0f / 2.2f));
+      lowpass.setPrecision(f64 ? dsp::SvfPrecision::kDouble : dsp::SvfPrecision::kFloat);
+      lowpass.setMode(nonlinear ? dsp::SvfMode::kNonlinear : dsp::SvfMode::kLinear);
+      const int rampSamples = static_cast<int>(0.02f * sampleRate);
+
+      results.push_back(measure(name, sampleRate, options, [&](int i) {
+        if (ramping && !lowpass.isRamping()) {
+          // Alternate between two cutoffs so a ramp is always in progress
+          float cutoff = ((i / 16) & 1) ? 400.0f : 4000.0f;
+          if (useTable) {
+            lowpass.setTarget(*table, table->locate(cutoff, 2.2f), rampSamples);
+          } else {
+            lowpass.setTarget(dsp::SvfCoeffs::make(cutoff / sampleRate, 1.0f / 2.2f), rampSamples);
+          }
+        }
+        ml::DSPVectorArray<2> samples = signal[i];
+        lowpass.process(samples);
+        gSink = gSink + samples[0];
+      }));
+    }
+  }
+}
+
+// The full effect through processVector, across sample rates and settings
+void benchEffect(const Options& options, std::vector<Result>& results) {
+  struct Preset {
+    const char* name;
+    ParamSettings params;
+    bool automate;
+  };
+  const Preset presets[] = {
+    { "default", {}, false },
+    { "wet-open-unity", { { "dry_wet", 1.0f }, { "lowpass", 20000.0f }, { "output", 1.0f } }, false },
+    { "mix", { { "dry_wet", 0.5f } }, false },
+    { "draft", { { "quality", 0.0f } }, false },
+    { "reference", { { "quality", 3.0f } }, false },
+    { "adaa1", { { "adaa", 1.0f } }, false },
+    { "os4-linear", { { "oversampling", 2.0f } }, false },
+    { "os8-minimum", { { "oversampling", 3.0f }, { "oversampling_mode", 1.0f } }, false },
+    { "bands2", { { "bands", 2.0f } }, false },
+    { "bands4", { { "bands", 4.0f } }, false },
+    { "bands4-os4-linear", { { "bands", 4.0f }, { "oversampling", 2.0f } }, false },
+    { "mid-side", { { "stereo_mode", 1.0f } }, false },
+    { "mid-only", { { "stereo_mode", 2.0f } }, false },
+    { "lowpass-50hz-q10", { { "lowpass", 50.0f }, { "lowpass_q", 10.0f } }, false },
+    { "lowpass-nonlinear", { { "lowpass_mode", 1.0f }, { "lowpass_q", 8.0f } }, false },
+    { "automation", { { "dry_wet", 0.7f } }, true }
+  };
+
+  for (float sampleRate : { 44100.0f, 48000.0f, 96000.0f, 192000.0f }) {
+    TestSignal signal(sampleRate);
+    for (const auto& preset : presets) {
+      std::string name = std::string("effect/") + preset.name + "/" + std::to_string(static_cast<int>(sampleRate));
+      if (name.find(options.filter) == std::string::npos) continue;
+
+      BenchSaturator effect;
+      effect.setSampleRate(sampleRate);
+      for (const auto& param : preset.params) {
+        effect.setParam(param.first, param.second);
+      }
+
+      ml::DSPVectorDynamic inputs(2), outputs(2);
+      results.push_back(measure(name, sampleRate, options, [&](int i) {
+        if (preset.automate) {
+          // Sweep cutoff, input gain and mix every vector, as dense host automation would
+          float phase = static_cast<float>(i) * 0.01f;
+          effect.setParam("lowpass", 1000.0f + 900.0f * std::sin(phase));
+          effect.setParam("input", 2.2f + std::sin(phase * 1.3f));
+          effect.setParam("dry_wet", 0.5f + 0.4f * std::sin(phase * 0.7f));
+        }
+        const auto& in = signal[i];
+        inputs[0] = in.constRow(0);
+        inputs[1] = in.constRow(1);
+        effect.processVector(inputs, outputs, nullptr);
+        gSink = gSink + outputs[0][0];
+      }));
+    }
+  }
+}
+
+// The full effect at every channel layout, in ns per sample of one channel
+void benchChannels(const Options& options, std::vector<Result>& results) {
+  const float sampleRate = 48000.0f;
+  TestSignal signal(sampleRate);
+  for (const auto& config : TanhSaturator::kChannelConfigs) {
+    const int channels = config.channels;
+    std::string name = "channels/" + std::to_string(channels) + "/" + std::to_string(static_cast<int>(sampleRate));
+    if (name.find(options.filter) == std::string::npos) continue;
+
+    BenchSaturator effect;
+    effect.setSampleRate(sampleRate);
+    effect.setChannelCount(channels);
+
+    ml::DSPVectorDynamic inputs(channels), outputs(channels);
+    Result result = measure(name, sampleRate, options, [&](int i) {
+      // Offset each channel pair in time so no two channels carry the same signal
+      for (int c = 0; c < channels; ++c) {
+        inputs[c] = signal[i + c / 2].constRow(c % 2);
+      }
+      effect.processVector(inputs, outputs, nullptr);
+      gSink = gSink + outputs[channels - 1][0];
+    });
+    result.nsPerSample /= channels;
+    result.nsPerSampleMedian /= channels;
+    results.push_back(result);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Instance cost
+
+// Resident memory of the process in bytes, or 0 where it can't be read
+size_t residentBytes() {
+#if defined(__linux__)
+  long totalPages = 0, residentPages = 0;
+  FILE* statm = std::fopen("/proc/self/statm", "r");
+  if (!statm) return 0;
+  int fields = std::fscanf(statm, "%ld %ld", &totalPages, &residentPages);
+  std::fclose(statm);
+  return (fields == 2) ? static_cast<size_t>(residentPages) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#elif defined(__APPLE__)
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) return 0;
+  return static_cast<size_t>(info.resident_size);
+#elif defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+  return static_cast<size_t>(counters.WorkingSetSize);
+#else
+  return 0;
+#endif
+}
+
+// Creates count processors and reports time and memory per instance. The first
+// instance is timed on its own since it also builds the resources shared by the rest.
+void benchInstances(int count) {
+  const float sampleRate = 48000.0f;
+  ml::DSPVectorDynamic inputs(2), outputs(2);
+
+  // Each instance is prepared and run for one vector, as a host would after activating it
+  auto prepare = [&](BenchSaturator& effect) {
+    effect.setSampleRate(sampleRate);
+    effect.processVector(inputs, outputs, nullptr);
+  };
+
+  using Clock = std::chrono::steady_clock;
+  auto firstStart = Clock::now();
+  auto first = std::make_unique<BenchSaturator>();
+  prepare(*first);
+  double firstMicros = std::chrono::duration<double, std::micro>(Clock::now() - firstStart).count();
+
+  std::vector<std::unique_ptr<BenchSaturator>> effects;
+  effects.reserve(count);
+  const size_t rssBefore = residentBytes();
+  auto start = Clock::now();
+  for (int i = 0; i < count; ++i) {
+    effects.push_back(std::make_unique<BenchSaturator>());
+    prepare(*effects.back());
+  }
+  double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  const size_t rssAfter = residentBytes();
+
+  std::printf("%d instance(s): first %.1f us, then %.1f us each", count, firstMicros, micros / count);
+  if (rssBefore > 0 && rssAfter > 0) {
+    std::printf(", %.1f KB resident each", (static_cast<double>(rssAfter) - static_cast<double>(rssBefore)) / 1024.0 / count);
+  }
+  std::printf(" (sizeof(TanhSaturator) = %zu bytes)\n", sizeof(TanhSaturator));
+}
+
+// Time to first process for sessions of several sizes, split into construction and
+// prepare + first vector. Each session starts from no live instances, so the
+// resources shared between instances are rebuilt by its first one, as after a load.
+void benchStartup() {
+  using Clock = std::chrono::steady_clock;
+  const float sampleRate = 48000.0f;
+  ml::DSPVectorDynamic inputs(2), outputs(2);
+
+  std::printf("%-10s %14s %14s %14s %14s\n", "instances", "construct us", "first proc us", "total ms", "per instance us");
+  for (int count : { 1, 100, 500 }) {
+    std::vector<std::unique_ptr<BenchSaturator>> effects;
+    effects.reserve(count);
+
+    auto start = Clock::now();
+    for (int i = 0; i < count; ++i) {
+      effects.push_back(std::make_unique<BenchSaturator>());
+    }
+    auto constructed = Clock::now();
+    for (auto& effect : effects) {
+      effect->setSampleRate(sampleRate);
+      effect->processVector(inputs, outputs, nullptr);
+    }
+    auto end = Clock::now();
+
+    const double constructMicros = std::chrono::duration<double, std::micro>(constructed - start).count();
+    const double processMicros = std::chrono::duration<double, std::micro>(end - constructed).count();
+    std::printf("%-10d %14.1f %14.1f %14.2f %14.1f\n", count, constructMicros, processMicros,
+                (constructMicros + processMicros) * 1e-3, (constructMicros + processMicros) / count);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// JSON output and comparison
+
+std::string toJson(const std::vector<Result>& results) {
+  std::ostringstream out;
+  out << "{\n  \"benchmark\": \"TanhSaturator\",\n  \"unit\": \"ns/sample\",\n  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& r = results[i];
+    char line[512];
+    std::snprintf(line, sizeof(line),
+                  "    { \"name\": \"%s\", \"sampleRate\": %.0f, \"nsPerSample\": %.4f, "
+                  "\"nsPerSampleMedian\": %.4f, \"realtimeFactor\": %.2f }%s\n",
+                  r.name.c_str(), r.sampleRate, r.nsPerSample, r.nsPerSampleMedian, r.realtimeFactor,
+                  (i + 1 < results.size()) ? "," : "");
+    out << line;
+  }
+  out << "  ]\n}\n";
+  return out.str();
+}
+
+// Reads name -> nsPerSample from a file written by toJson(). Returns false if the
+// file can't be opened or holds no cases.
+bool readBaseline(const std::string& path, std::map<std::string, double>& baseline) {
+  std::ifstream in(path);
+  if (!in) return false;
+
+  std::string line;
+  while (std::getline(in, line)) {
+    auto namePos = line.find("\"name\": \"");
+    auto timePos = line.find("\"nsPerSample\": ");
+    if (namePos == std::string::npos || timePos == std::string::npos) continue;
+    namePos += std::strlen("\"name\": \"");
+    auto nameEnd = line.find('"', namePos);
+    baseline[line.substr(namePos, nameEnd - namePos)] = std::atof(line.c_str() + timePos + std::strlen("\"nsPerSample\": "));
+  }
+  return !baseline.empty();
+}
+
+struct Comparison {
+  int compared = 0;
+  int regressions = 0;
+  int missing = 0;
+};
+
+// Prints a comparison table. Cases without a usable baseline time are listed
+// as missing instead of being compared.
+Comparison compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline,
+                   double thresholdPercent) {
+  Comparison comparison;
+  std::printf("\n%-44s %12s %12s %9s\n", "case", "baseline", "current", "change");
+  for (const auto& r : results) {
+    auto it = baseline.find(r.name);
+    if (it == baseline.end() || it->second <= 0.0) {
+      comparison.missing++;
+      std::printf("%-44s %12s %12.3f %9s  MISSING\n", r.name.c_str(), "-", r.nsPerSample, "");
+      continue;
+    }
+
+    double change = 100.0 * (r.nsPerSample - it->second) / it->second;
+    bool regressed = change > thresholdPercent;
+    comparison.compared++;
+    comparison.regressions += regressed ? 1 : 0;
+    std::printf("%-44s %12.3f %12.3f %+8.1f%%%s\n", r.name.c_str(), it->second, r.nsPerSample, change,
+                regressed ? "  REGRESSION" : "");
+  }
+  return comparison;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--out" && hasValue) {
+      options.outPath = argv[++i];
+    } else if (arg == "--compare" && hasValue) {
+      options.comparePath = argv[++i];
+    } else if (arg == "--threshold" && hasValue) {
+      options.thresholdPercent = std::atof(argv[++i]);
+    } else if (arg == "--seconds" && hasValue) {
+      options.audioSeconds = std::max(0.01, std::atof(argv[++i]));
+    } else if (arg == "--repeats" && hasValue) {
+      options.repeats = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--filter" && hasValue) {
+      options.filter = argv[++i];
+    } else if (arg == "--instances" && hasValue) {
+      options.instances = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--startup") {
+      options.startup = true;
+    } else if (arg == "--check") {
+      options.check = true;
+    } else if (arg == "--golden" && hasValue) {
+      options.checkOptions.goldenDir = argv[++i];
+    } else if (arg == "--update-golden") {
+      options.checkOptions.updateGolden = true;
+    } else {
+      std::fprintf(stderr,
+                   "usage: %s [--out results.json] [--compare baseline.json] [--threshold percent]\n"
+                   "          [--seconds s] [--repeats n] [--filter text]\n"
+                   "       %s --instances n\n"
+                   "       %s --startup\n"
+                   "       %s --check [--golden dir [--update-golden]] [--filter text]\n", argv[0], argv[0], argv[0], argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Everything main() does before shutting the tracer down
+int run(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) return 2;
+
+  if (options.instances > 0) {
+    benchInstances(options.instances);
+    return 0;
+  }
+
+  if (options.startup) {
+    benchStartup();
+    return 0;
+  }
+
+  if (options.check) {
+    options.checkOptions.filter = options.filter;
+    return runChecks(options.checkOptions) > 0 ? 1 : 0;
+  }
+
+  std::vector<Result> results;
+  benchSaturation(options, results);
+  benchLowpass(options, results);
+  benchEffect(options, results);
+  benchChannels(options, results);
+
+  std::printf("%-44s %10s %10s %12s\n", "case", "ns/sample", "median", "x realtime");
+  for (const auto& r : results) {
+    std::printf("%-44s %10.3f %10.3f %12.1f\n", r.name.c_str(), r.nsPerSample, r.nsPerSampleMedian, r.realtimeFactor);
+  }
+
+  if (!options.outPath.empty()) {
+    std::ofstream out(options.outPath);
+    out << toJson(results);
+    if (!out) {
+      std::fprintf(stderr, "could not write %s\n", options.outPath.c_str());
+      return 2;
+    }
+  }
+
+  if (!options.comparePath.empty()) {
+    std::map<std::string, double> baseline;
+    if (!readBaseline(options.comparePath, baseline)) {
+      std::fprintf(stderr, "could not read baseline %s, or it holds no cases\n", options.comparePath.c_str());
+      return 2;
+    }
+    Comparison comparison = compare(results, baseline, options.thresholdPercent);
+    if (comparison.missing > 0) {
+      std::printf("\n%d of %d case(s) missing from the baseline\n", comparison.missing, int(results.size()));
+    }
+    if (comparison.compared == 0) {
+      std::fprintf(stderr, "baseline %s shares no case with this run\n", options.comparePath.c_str());
+      return 2;
+    }
+    if (comparison.regressions > 0) {
+      std::printf("\n%d of %d case(s) regressed by more than %.1f%%\n", comparison.regressions, comparison.compared,
+                  options.thresholdPercent);
+      return 1;
+    }
+    std::printf("\nno regressions over %.1f%% in %d case(s)\n", options.thresholdPercent, comparison.compared);
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const int result = run(argc, argv);
+  // Completes the trace file in builds with ENABLE_TRACING
+  trace::shutdown();
+  return result;
+}
@@ -0,0 +1,806 @@
+// TanhSaturator-check - golden renders and fast-path equivalence checks
+//
+// Run with TanhSaturator-bench --check [--golden DIR [--update-golden]] [--filter text].
+// Every case prints its error next to its tolerance; the exit code is 1 if any fails.
+//
+//   tanh/       every kernel tier, scalar and packed, against std::tanh in double
+//   adaa/       first- and second-order ADAA against double references, and lane equivalence
+//   lowpass/    the SVF in float and double, linear and nonlinear, against a double
+//               reference with the same coefficients, at stereo and wide pack widths,
+//               and the shared coefficient table's g and k against SvfCoeffs::make
+//   crossover/  the bands of the crossover, summed, against a flat magnitude response
+//   packs/      stereo-pack and wide-pack channels of the full effect against each other,
+//               a half-wet mix against the wet render plus the input delayed by the latency,
+//               and a 6-channel layout given stereo buffers against the stereo layout
+//   stereo/     mid-only and mid/side on a mono signal against left/right
+//   alias/      aliasing of the saturator per oversampling factor and ADAA order,
+//               which must fall by a set amount with each step of anti-aliasing
+//   golden/     sweeps, impulses, noise and DC steps at several drive levels through
+//               the full effect, and through presets with oversampling, ADAA, bands,
+//               mid/side and the nonlinear filter, against the reference renders in
+//               the golden directory
+//
+// Errors are the largest absolute difference, divided by the reference's peak where
+// noted. Golden references are a quarter second of raw interleaved float32 stereo at
+// 48 kHz, written by --update-golden; a missing reference fails its case.
+
+#include "TanhSaturator-check.h"
+#include "TanhSaturator.h"
+#include "dsp/Fft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kVectorSize = static_cast<int>(ml::kFloatsPerDSPVector);
+constexpr double kPi = 3.14159265358979323846;
+
+// Exposes parameter setting, which CLAPSignalProcessor keeps protected
+class CheckSaturator : public TanhSaturator {
+public:
+  void setParam(const char* name, float value) { _params.setFromRealValue(ml::Path(name), value); }
+};
+
+using ParamSettings = std::vector<std::pair<const char*, float>>;
+
+class Checker {
+public:
+  explicit Checker(const CheckOptions& options) : _options(options) {}
+
+  bool wants(const std::string& name) const { return name.find(_options.filter) != std::string::npos; }
+
+  // Records one case: passes if error <= tolerance
+  void expect(const std::string& name, double error, double tolerance) {
+    const bool passed = std::isfinite(error) && error <= tolerance;
+    _failures += passed ? 0 : 1;
+    std::printf("%-52s %12.3g %12.3g  %s\n", name.c_str(), error, tolerance, passed ? "ok" : "FAIL");
+  }
+
+  // Records one case that couldn't be measured as failed
+  void fail(const std::string& name, const char* reason) {
+    ++_failures;
+    std::printf("%-52s %27s  FAIL: %s\n", name.c_str(), "", reason);
+  }
+
+  const CheckOptions& options() const { return _options; }
+  int failures() const { return _failures; }
+
+private:
+  const CheckOptions& _options;
+  int _failures = 0;
+};
+
+// Deterministic white noise in [-0.5, 0.5)
+class Noise {
+public:
+  float next() {
+    _seed = _seed * 1664525u + 1013904223u;
+    return static_cast<float>(_seed >> 8) / 16777216.0f - 0.5f;
+  }
+
+private:
+  uint32_t _seed = 0x12345678u;
+};
+
+// ---------------------------------------------------------------------------
+// tanh kernels
+
+// Documented bounds from FastTanh.h with a small margin for libm differences, per quality
+constexpr double kTanhTolerances[] = { 7.5e-3, 8e-5, 3e-6, 1e-6 };
+
+void checkTanh(Checker& checker) {
+  const char* names[] = { "draft", "standard", "high", "reference" };
+  const double* tolerances = kTanhTolerances;
+
+  // Dense grid over [-12, 12], which covers every clamp point and the table range
+  constexpr int kPoints = 24 * 1024 * 4;
+  std::vector<float> grid(kPoints);
+  for (int i = 0; i < kPoints; ++i) grid[i] = -12.0f + 24.0f * static_cast<float>(i) / (kPoints - 1);
+
+  for (int q = 0; q < static_cast<int>(dsp::TanhQuality::kNumQualities); ++q) {
+    const auto quality = static_cast<dsp::TanhQuality>(q);
+    const std::string base = std::string("tanh/") + names[q];
+    double scalarError = 0.0, doubleError = 0.0, packedError = 0.0;
+
+    for (int i = 0; i < kPoints; ++i) {
+      const double reference = std::tanh(static_cast<double>(grid[i]));
+      scalarError = std::max(scalarError, std::fabs(dsp::tanhKernel(quality, grid[i]) - reference));
+      doubleError = std::max(doubleError, std::fabs(dsp::tanhKernel(quality, static_cast<double>(grid[i])) - reference));
+    }
+
+    // Four lanes at a time, as the wide packs run it
+    constexpr int kPackSize = 4 * kVectorSize;
+    for (int start = 0; start + kPackSize <= kPoints; start += kPackSize) {
+      ml::DSPVectorArray<4> x;
+      std::copy(grid.begin() + start, grid.begin() + start + kPackSize, x.getBuffer());
+      const ml::DSPVectorArray<4> y = dsp::tanhKernel(quality, x);
+      const float* py = y.getConstBuffer();
+      for (int i = 0; i < kPackSize; ++i) {
+        packedError = std::max(packedError, std::fabs(py[i] - std::tanh(static_cast<double>(grid[start + i]))));
+      }
+    }
+
+    if (checker.wants(base + "/scalar")) checker.expect(base + "/scalar", scalarError, tolerances[q]);
+    if (checker.wants(base + "/double")) checker.expect(base + "/double", doubleError, tolerances[q]);
+    if (checker.wants(base + "/packed")) checker.expect(base + "/packed", packedError, tolerances[q]);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ADAA
+
+// A driven sine with noise, large enough to reach deep into the saturation. The
+// last quarter exercises the fallbacks for close inputs: held values, a pattern
+// repeating every other sample, a slow ramp and inputs far into the tails.
+std::vector<float> adaaStimulus(int vectors) {
+  Noise noise;
+  std::vector<float> x(static_cast<size_t>(vectors) * kVectorSize);
+  const size_t fallbacks = x.size() * 3 / 4;
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = 4.0f * std::sin(static_cast<float>(2.0 * kPi * 1000.0 * i / 48000.0)) + noise.next();
+    if (i < fallbacks) continue;
+    switch ((i - fallbacks) / 512 % 5) {
+      case 0: x[i] = ((i / 100) & 1) ? 0.7f : -1.3f; break;
+      case 1: x[i] = (i & 1) ? 1.3f : 0.2f; break;
+      case 2: x[i] = -2.0f + 4.0f * static_cast<float>(i % 512) / 512.0f * 1e-4f; break;
+      case 3: x[i] = (i & 1) ? 400.0f : -3.0f; break;
+      default: x[i] = ((i / 3) & 1) ? 1e5f : -1e5f; break;
+    }
+  }
+  return x;
+}
+
+// Runs x through a TanhAdaa<LANES> with the same signal in every lane and returns lane "lane"
+template <size_t LANES>
+std::vector<float> runAdaa(dsp::AdaaOrder order, const std::vector<float>& x, size_t lane) {
+  dsp::TanhAdaa<LANES> adaa;
+  adaa.setOrder(order);
+  std::vector<float> y(x.size());
+  for (size_t start = 0; start < x.size(); start += kVectorSize) {
+    ml::DSPVectorArray<LANES> pack;
+    for (size_t c = 0; c < LANES; ++c) {
+      std::copy(x.begin() + start, x.begin() + start + kVectorSize, pack.getBuffer() + c * kVectorSize);
+    }
+    const ml::DSPVectorArray<LANES> out = adaa.process(pack, dsp::TanhQuality::kStandard);
+    std::copy(out.getConstBuffer() + lane * kVectorSize, out.getConstBuffer() + (lane + 1) * kVectorSize, y.begin() + start);
+  }
+  return y;
+}
+
+double maxDifference(const std::vector<float>& a, const std::vector<float>& b) {
+  double error = 0.0;
+  for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+    error = std::max(error, std::fabs(static_cast<double>(a[i]) - b[i]));
+  }
+  return error;
+}
+
+// Largest error of g(x) = log(1 + e^-2|x|) as processFirstOrder() computes it in float
+double firstOrderGError() {
+  double error = 0.0;
+  for (int start = 0; start < 64 * 1024; start += kVectorSize) {
+    ml::DSPVector x;
+    for (int i = 0; i < kVectorSize; ++i) x[i] = static_cast<float>(start + i) / 2048.0f;
+    const ml::DSPVector g = dsp::vlog(ml::DSPVector(1.0f) + dsp::vexp(ml::DSPVector(-2.0f) * x));
+    for (int i = 0; i < kVectorSize; ++i) {
+      error = std::max(error, std::fabs(g[i] - std::log1p(std::exp(-2.0 * x[i]))));
+    }
+  }
+  return error;
+}
+
+// Error bound for first-order ADAA against the double reference. The two branches
+// never mix in one sample, so the bound is the larger of:
+// - the quotient: the g terms of both inputs, divided by the smallest |dx| taken,
+//   plus a few float roundings of a result no larger than 1;
+// - the midpoint fallback: the standard tanh kernel plus the truncation of the
+//   midpoint rule, |tanh''| / 24 * dx^2 with |tanh''| <= 4 / (3 sqrt 3).
+double firstOrderTolerance() {
+  const double epsilon = dsp::kAdaaFirstOrderEpsilon;
+  const double quotient = 2.0 * firstOrderGError() / epsilon + 4.0 * std::ldexp(1.0, -24);
+  const double midpoint = kTanhTolerances[static_cast<int>(dsp::TanhQuality::kStandard)] +
+                          4.0 / (3.0 * std::sqrt(3.0)) / 24.0 * epsilon * epsilon;
+  return std::max(quotient, midpoint);
+}
+
+void checkAdaa(Checker& checker) {
+  const std::vector<float> x = adaaStimulus(256);
+
+  // First-order reference: divided difference of log(cosh(x)) in double, with the
+  // same midpoint fallback for close inputs. The state starts at x = 0.
+  if (checker.wants("adaa/first/reference")) {
+    std::vector<float> reference(x.size());
+    double x1 = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+      const double x0 = x[i];
+      const double dx = x0 - x1;
+      reference[i] = static_cast<float>(std::fabs(dx) < dsp::kAdaaFirstOrderEpsilon
+                                            ? std::tanh(0.5 * (x0 + x1))
+                                            : (dsp::tanhAntiderivative1(x0) - dsp::tanhAntiderivative1(x1)) / dx);
+      x1 = x0;
+    }
+    checker.expect("adaa/first/reference", maxDifference(runAdaa<2>(dsp::AdaaOrder::kFirst, x, 0), reference),
+                   firstOrderTolerance());
+  }
+
+  // Second-order reference: second divided difference of F2 in double, with both
+  // first differences taken afresh each sample rather than carried over. Close
+  // inputs fall back to the limits: x[n] ~ x[n-2] leaves a difference around
+  // x[n-1], and three close inputs give tanh at their midpoint.
+  if (checker.wants("adaa/second/reference")) {
+    constexpr double kEpsilon = 1e-3;
+    auto firstDifference = [&](double a, double b) {
+      return std::fabs(a - b) < kEpsilon ? dsp::tanhAntiderivative1(0.5 * (a + b))
+                                         : (dsp::tanhAntiderivative2(a) - dsp::tanhAntiderivative2(b)) / (a - b);
+    };
+    std::vector<float> reference(x.size());
+    double x1 = 0.0, x2 = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+      const double x0 = x[i];
+      double y;
+      if (std::fabs(x0 - x2) >= kEpsilon) {
+        y = 2.0 * (firstDifference(x0, x1) - firstDifference(x1, x2)) / (x0 - x2);
+      } else {
+        const double xBar = 0.5 * (x0 + x2);
+        const double delta = xBar - x1;
+        y = std::fabs(delta) < kEpsilon
+              ? std::tanh(0.5 * (xBar + x1))
+              : (2.0 / delta) * (dsp::tanhAntiderivative1(xBar) +
+                                 (dsp::tanhAntiderivative2(x1) - dsp::tanhAntiderivative2(xBar)) / delta);
+      }
+      reference[i] = static_cast<float>(y);
+      x2 = x1;
+      x1 = x0;
+    }
+    checker.expect("adaa/second/reference", maxDifference(runAdaa<2>(dsp::AdaaOrder::kSecond, x, 0), reference), 1e-5);
+  }
+
+  // Every lane of every pack width computes the same thing
+  for (auto order : { dsp::AdaaOrder::kFirst, dsp::AdaaOrder::kSecond }) {
+    const std::string name = std::string("adaa/") + (order == dsp::AdaaOrder::kFirst ? "first" : "second") + "/lanes";
+    if (!checker.wants(name)) continue;
+    const std::vector<float> stereo = runAdaa<2>(order, x, 1);
+    double error = maxDifference(stereo, runAdaa<4>(order, x, 3));
+    error = std::max(error, maxDifference(stereo, runAdaa<8>(order, x, 5)));
+    checker.expect(name, error, 1e-6);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Lowpass
+
+// Noise plus a loud sine at the cutoff, so a resonant filter rings near its peak
+std::vector<float> lowpassStimulus(float sampleRate, float hz, int vectors) {
+  Noise noise;
+  std::vector<float> x(static_cast<size_t>(vectors) * kVectorSize);
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = 0.1f * noise.next() + 0.9f * static_cast<float>(std::sin(2.0 * kPi * hz * i / sampleRate));
+  }
+  return x;
+}
+
+// The trapezoidal SVF in double, with the coefficients widened from c
+std::vector<double> referenceLowpass(const dsp::SvfCoeffs& c, bool nonlinear, const std::vector<float>& x) {
+  const double a1 = c.a1, a2 = c.a2, a3 = c.a3;
+  double s1 = 0.0, s2 = 0.0;
+  std::vector<double> y(x.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    const double bp = nonlinear ? std::tanh(s1) : s1;
+    const double v3 = x[i] - s2;
+    const double v1 = a1 * bp + a2 * v3;
+    const double v2 = s2 + a2 * bp + a3 * v3;
+    s1 = 2.0 * v1 - bp;
+    s2 = 2.0 * v2 - s2;
+    y[i] = v2;
+  }
+  return y;
+}
+
+// Largest difference over every lane, relative to the reference's peak
+template <size_t LANES>
+double lowpassError(const dsp::SvfCoeffs& c, dsp::SvfPrecision precision, dsp::SvfMode mode, const std::vector<float>& x,
+                    const std::vector<double>& reference) {
+  dsp::SvfLowpass<LANES> lowpass;
+  lowpass.setCoeffs(c);
+  lowpass.setPrecision(precision);
+  lowpass.setMode(mode);
+
+  double error = 0.0, peak = 0.0;
+  for (size_t start = 0; start < x.size(); start += kVectorSize) {
+    ml::DSPVectorArray<LANES> pack;
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      std::copy(x.begin() + start, x.begin() + start + kVectorSize, pack.getBuffer() + lane * kVectorSize);
+    }
+    lowpass.process(pack);
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      for (int i = 0; i < kVectorSize; ++i) {
+        const double r = reference[start + i];
+        error = std::max(error, std::fabs(pack.getConstBuffer()[lane * kVectorSize + i] - r));
+        peak = std::max(peak, std::fabs(r));
+      }
+    }
+  }
+  return error / std::max(peak, 1e-9);
+}
+
+void checkLowpass(Checker& checker) {
+  struct Setting {
+    const char* name;
+    float sampleRate, hz, q;
+    double floatTolerance;  // the float recursion loses precision at low cutoff and high Q
+  };
+  const Setting settings[] = {
+    { "1500hz-q2.2-48k", 48000.0f, 1500.0f, 2.2f, 2e-5 },
+    { "9khz-q0.7-48k", 48000.0f, 9000.0f, 0.7f, 2e-5 },
+    { "50hz-q10-96k", 96000.0f, 50.0f, 10.0f, 2e-4 },
+    { "50hz-q10-192k", 192000.0f, 50.0f, 10.0f, 5e-4 }
+  };
+
+  for (const auto& s : settings) {
+    const std::vector<float> x = lowpassStimulus(s.sampleRate, s.hz, 2048);
+    const auto coeffs = dsp::SvfCoeffs::make(s.hz / s.sampleRate, 1.0f / s.q);
+    for (auto mode : { dsp::SvfMode::kLinear, dsp::SvfMode::kNonlinear }) {
+      const bool nonlinear = mode == dsp::SvfMode::kNonlinear;
+      const std::vector<double> reference = referenceLowpass(coeffs, nonlinear, x);
+      const std::string base = std::string("lowpass/") + (nonlinear ? "nonlinear/" : "linear/") + s.name;
+
+      if (checker.wants(base + "/f32x2")) {
+        checker.expect(base + "/f32x2", lowpassError<2>(coeffs, dsp::SvfPrecision::kFloat, mode, x, reference), s.floatTolerance);
+      }
+      if (checker.wants(base + "/f32x4")) {
+        checker.expect(base + "/f32x4", lowpassError<4>(coeffs, dsp::SvfPrecision::kFloat, mode, x, reference), s.floatTolerance);
+      }
+      if (checker.wants(base + "/f64x2")) {
+        checker.expect(base + "/f64x2", lowpassError<2>(coeffs, dsp::SvfPrecision::kDouble, mode, x, reference), 1e-6);
+      }
+      if (checker.wants(base + "/f64x4")) {
+        checker.expect(base + "/f64x4", lowpassError<4>(coeffs, dsp::SvfPrecision::kDouble, mode, x, reference), 1e-6);
+      }
+      // The automatic choice must keep every setting within the float tolerance of the easy ones
+      if (checker.wants(base + "/autox2")) {
+        checker.expect(base + "/autox2", lowpassError<2>(coeffs, dsp::SvfPrecision::kAuto, mode, x, reference), 2e-5);
+      }
+    }
+  }
+}
+
+// The shared coefficient table against SvfCoeffs::make, on its grid points and at
+// quarter steps between them. On the grid only float rounding remains. Between
+// points g and k are interpolated linearly in log frequency and log Q, so with a
+// grid step of h octaves the relative error is bounded by (h ln2)^2 / 8 times the
+// curvature of the coefficient against log2 of its axis, relative to its value:
+// 1 for k = 1 / Q, and for g = tan(theta), largest at the top of the table,
+// theta / (sin theta cos theta) + 2 theta^2 / cos^2 theta.
+void checkCoeffTable(Checker& checker) {
+  using Table = dsp::SvfCoeffTable;
+  constexpr int kSteps = 4;
+  for (float sampleRate : { 44100.0f, 48000.0f, 96000.0f, 192000.0f }) {
+    const std::string base = "lowpass/table/" + std::to_string(static_cast<int>(sampleRate));
+    if (!checker.wants(base)) continue;
+    const auto table = Table::acquire(sampleRate);
+
+    const double maxHz = std::min(Table::kMaxHz, Table::kMaxOmega * sampleRate);
+    const double freqStep = std::log2(maxHz / Table::kMinHz) / (Table::kFreqPoints - 1);
+    const double qStep = std::log2(static_cast<double>(Table::kMaxQ) / Table::kMinQ) / (Table::kQPoints - 1);
+    const double theta = kPi * maxHz / sampleRate;
+    const double gCurvature = theta / (std::sin(theta) * std::cos(theta)) + 2.0 * theta * theta / (std::cos(theta) * std::cos(theta));
+    const double gBound = std::pow(freqStep * std::log(2.0), 2.0) / 8.0 * gCurvature;
+    const double kBound = std::pow(qStep * std::log(2.0), 2.0) / 8.0;
+
+    double gridError = 0.0, gError = 0.0, kError = 0.0;
+    for (int i = 0; i <= kSteps * (Table::kFreqPoints - 1); ++i) {
+      for (int j = 0; j <= kSteps * (Table::kQPoints - 1); ++j) {
+        const double hz = Table::kMinHz * std::exp2(freqStep * i / kSteps);
+        const double q = Table::kMinQ * std::exp2(qStep * j / kSteps);
+        const dsp::SvfCoeffs c = table->lookup(table->locate(static_cast<float>(hz), static_cast<float>(q)));
+        const dsp::SvfCoeffs r = dsp::SvfCoeffs::make(static_cast<float>(hz / sampleRate), static_cast<float>(1.0 / q));
+        const double g = std::fabs(static_cast<double>(c.g) - r.g) / r.g;
+        const double k = std::fabs(static_cast<double>(c.k) - r.k) / r.k;
+        if (i % kSteps == 0 && j % kSteps == 0) {
+          gridError = std::max(gridError, std::max(g, k));
+        } else {
+          gError = std::max(gError, g);
+          kError = std::max(kError, k);
+        }
+      }
+    }
+    checker.expect(base + "/grid", gridError, 1e-5);
+    checker.expect(base + "/between-g", gError, 1.05 * gBound);
+    checker.expect(base + "/between-k", kError, 1.05 * kBound);
+  }
+}
+
+// The crossover's bands, with coefficients from the table, must sum back to an
+// allpass: the magnitude of the summed impulse response stays at 0 dB.
+void checkCrossover(Checker& checker) {
+  constexpr int kSize = 8192;
+  const float splits[dsp::kMaxBands - 1] = { 200.0f, 1000.0f, 5000.0f };
+  for (float sampleRate : { 44100.0f, 48000.0f, 96000.0f }) {
+    for (int nBands = 2; nBands <= dsp::kMaxBands; ++nBands) {
+      const std::string name = "crossover/flat/" + std::to_string(nBands) + "bands-" + std::to_string(static_cast<int>(sampleRate));
+      if (!checker.wants(name)) continue;
+      const auto table = dsp::SvfCoeffTable::acquire(sampleRate);
+      dsp::Crossover<2> crossover;
+      crossover.setBands(nBands, *table, splits, 0);
+
+      std::vector<std::complex<float>> spectrum(kSize);
+      for (int start = 0; start < kSize; start += kVectorSize) {
+        ml::DSPVectorArray<2> input;
+        if (start == 0) input.getBuffer()[0] = input.getBuffer()[kVectorSize] = 1.0f;
+        ml::DSPVectorArray<2 * dsp::kMaxBands> bands;
+        crossover.process<dsp::kMaxBands>(input, bands);
+        for (int i = 0; i < kVectorSize; ++i) {
+          float sum = 0.0f;
+          for (int b = 0; b < dsp::kMaxBands; ++b) sum += bands.getConstBuffer()[dsp::Crossover<2>::row(b, 0) * kVectorSize + i];
+          spectrum[start + i] = std::complex<float>(sum, 0.0f);
+        }
+      }
+      dsp::Fft(kSize).forward(spectrum.data());
+
+      double error = 0.0;
+      for (int k = 1; k < kSize / 2; ++k) {
+        error = std::max(error, std::fabs(20.0 * std::log10(std::abs(spectrum[k]))));
+      }
+      checker.expect(name, error, 1e-3);
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Full effect
+
+// Renders stereo input (left then right, equal lengths) through a fresh effect with
+// channels channels, feeding the stereo pair to every pair of channels. Returns the
+// outputs, one buffer per channel. A nonzero layoutChannels sets the effect's
+// channel layout apart from the number of buffers.
+std::vector<std::vector<float>> renderEffect(const ParamSettings& params, int channels, const std::vector<float>& left,
+                                             const std::vector<float>& right, float sampleRate = 48000.0f,
+                                             int layoutChannels = 0) {
+  CheckSaturator effect;
+  effect.setSampleRate(sampleRate);
+  effect.setChannelCount(layoutChannels ? layoutChannels : channels);
+  for (const auto& param : params) effect.setParam(param.first, param.second);
+  effect.resetProcessingState();
+
+  std::vector<std::vector<float>> out(channels, std::vector<float>(left.size()));
+  ml::DSPVectorDynamic inputs(channels), outputs(channels);
+  for (size_t start = 0; start + kVectorSize <= left.size(); start += kVectorSize) {
+    for (int c = 0; c < channels; ++c) {
+      const std::vector<float>& source = (c % 2 == 0) ? left : right;
+      for (int i = 0; i < kVectorSize; ++i) inputs[c][i] = source[start + i];
+    }
+    effect.processVector(inputs, outputs, nullptr);
+    for (int c = 0; c < channels; ++c) {
+      for (int i = 0; i < kVectorSize; ++i) out[c][start + i] = outputs[c][i];
+    }
+  }
+  return out;
+}
+
+void checkPacks(Checker& checker) {
+  Noise noise;
+  std::vector<float> left(48000 / kVectorSize * kVectorSize), right(left.size());
+  for (size_t i = 0; i < left.size(); ++i) {
+    left[i] = 0.7f * static_cast<float>(std::sin(2.0 * kPi * 220.0 * i / 48000.0)) + 0.2f * noise.next();
+    right[i] = 0.5f * noise.next();
+  }
+
+  const std::pair<const char*, ParamSettings> presets[] = {
+    { "default", {} },
+    { "os4-adaa1", { { "oversampling", 2.0f }, { "adaa", 1.0f } } },
+    { "bands4", { { "bands", 4.0f } } },
+    { "nonlinear-f64", { { "lowpass_mode", 1.0f }, { "lowpass", 50.0f }, { "lowpass_q", 10.0f } } }
+  };
+
+  for (const auto& preset : presets) {
+    // 6 channels: channels 0-3 on a wide pack, 4-5 on the stereo pack
+    const std::string name = std::string("packs/") + preset.first + "/wide-vs-stereo";
+    if (!checker.wants(name)) continue;
+    const auto stereo = renderEffect(preset.second, 2, left, right);
+    const auto surround = renderEffect(preset.second, 6, left, right);
+    double error = 0.0;
+    for (int c = 0; c < 6; ++c) error = std::max(error, maxDifference(stereo[c % 2], surround[c]));
+    checker.expect(name, error, 1e-6);
+  }
+
+  // A half-wet mix is the fully wet render and the input delayed by the reported
+  // latency, so the dry signal must line up with the oversampled wet path
+  const std::pair<const char*, ParamSettings> mixPresets[] = {
+    { "os4-linear", { { "oversampling", 2.0f }, { "oversampling_mode", 0.0f } } },
+    { "os4-minimum-adaa2", { { "oversampling", 2.0f }, { "oversampling_mode", 1.0f }, { "adaa", 2.0f } } }
+  };
+  for (const auto& preset : mixPresets) {
+    const std::string name = std::string("packs/") + preset.first + "/dry-wet-aligned";
+    if (!checker.wants(name)) continue;
+
+    CheckSaturator effect;
+    for (const auto& param : preset.second) effect.setParam(param.first, param.second);
+    const size_t latency = effect.getLatencySamples();
+
+    ParamSettings wetParams = preset.second, mixParams = preset.second;
+    wetParams.push_back({ "dry_wet", 1.0f });
+    mixParams.push_back({ "dry_wet", 0.5f });
+    const auto wet = renderEffect(wetParams, 2, left, right);
+    const auto mix = renderEffect(mixParams, 2, left, right);
+
+    // dry_wet = 0.5 gives dry gain 1 - 0.5^2 and wet gain 0.5^2
+    double error = 0.0;
+    for (int c = 0; c < 2; ++c) {
+      const std::vector<float>& input = (c == 0) ? left : right;
+      for (size_t i = 0; i < input.size(); ++i) {
+        const double dry = (i >= latency) ? input[i - latency] : 0.0;
+        error = std::max(error, std::fabs(mix[c][i] - (0.75 * dry + 0.25 * wet[c][i])));
+      }
+    }
+    checker.expect(name, error, 1e-5);
+  }
+
+  // Buffers for fewer channels than the layout: only those channels are processed
+  if (checker.wants("packs/default/short-buffers")) {
+    const auto stereo = renderEffect({}, 2, left, right);
+    const auto shortBuffers = renderEffect({}, 2, left, right, 48000.0f, 6);
+    double error = 0.0;
+    for (int c = 0; c < 2; ++c) error = std::max(error, maxDifference(stereo[c], shortBuffers[c]));
+    checker.expect("packs/default/short-buffers", error, 1e-6);
+  }
+}
+
+void checkStereoModes(Checker& checker) {
+  // With the same signal on both sides, side is silent, so the mid/side modes must
+  // reproduce left/right processing
+  std::vector<float> mono(48000 / kVectorSize * kVectorSize);
+  Noise noise;
+  for (size_t i = 0; i < mono.size(); ++i) {
+    mono[i] = 0.8f * static_cast<float>(std::sin(2.0 * kPi * 330.0 * i / 48000.0)) + 0.1f * noise.next();
+  }
+  const auto reference = renderEffect({}, 2, mono, mono);
+  for (const auto& mode : { std::make_pair("mid-side", 1.0f), std::make_pair("mid-only", 2.0f) }) {
+    const std::string name = std::string("stereo/") + mode.first + "/mono-equals-lr";
+    if (!checker.wants(name)) continue;
+    const auto out = renderEffect({ { "stereo_mode", mode.second } }, 2, mono, mono);
+    checker.expect(name, std::max(maxDifference(out[0], reference[0]), maxDifference(out[1], reference[1])), 1e-5);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Aliasing
+
+// Power of everything but the harmonics of a sine at bin "bin", relative to the
+// total, in dB. A Hann window keeps the leakage of the harmonics within two bins.
+double aliasingDb(const std::vector<float>& y, int bin) {
+  const int size = static_cast<int>(y.size());
+  dsp::Fft fft(size);
+  std::vector<std::complex<float>> spectrum(size);
+  for (int i = 0; i < size; ++i) {
+    const float window = 0.5f - 0.5f * static_cast<float>(std::cos(2.0 * kPi * i / size));
+    spectrum[i] = std::complex<float>(y[i] * window, 0.0f);
+  }
+  fft.forward(spectrum.data());
+
+  double total = 0.0, harmonics = 0.0;
+  for (int k = 1; k < size / 2; ++k) {
+    const double power = std::norm(spectrum[k]);
+    total += power;
+    const int nearest = ((k + bin / 2) / bin) * bin;
+    if (std::abs(k - nearest) <= 2) harmonics += power;
+  }
+  return 10.0 * std::log10(std::max(total - harmonics, 1e-30) / std::max(total, 1e-30));
+}
+
+// Saturates a driven sine with the given oversampling and ADAA and measures the aliasing
+double measureAliasing(int factorLog2, dsp::AdaaOrder order) {
+  constexpr int kSize = 8192;
+  // About 12.5 kHz at 48 kHz, with harmonics that fold between bins. High enough
+  // that every factor up to 8x still leaves aliasing above the floor set by the
+  // halfband stopbands, which a 5 kHz tone already reaches at 4x.
+  constexpr int kBin = 2131;
+  constexpr int kSettle = 16;
+
+  dsp::Oversampler<2> oversampler;
+  dsp::TanhAdaa<2> adaa;
+  oversampler.setFactor(factorLog2);
+  adaa.setOrder(order);
+
+  std::vector<float> y;
+  for (int v = 0; v < kSize / kVectorSize + kSettle; ++v) {
+    ml::DSPVectorArray<2> samples;
+    for (int i = 0; i < kVectorSize; ++i) {
+      const float x = 4.0f * static_cast<float>(std::sin(2.0 * kPi * kBin * (v * kVectorSize + i) / kSize));
+      samples.getBuffer()[i] = samples.getBuffer()[kVectorSize + i] = x;
+    }
+    if (factorLog2 == 0) {
+      samples = adaa.process(samples, dsp::TanhQuality::kReference);
+    } else {
+      oversampler.upsample(samples);
+      for (int r = 0; r < oversampler.getFactor(); ++r) {
+        oversampler.pack(r) = adaa.process(oversampler.pack(r), dsp::TanhQuality::kReference);
+      }
+      oversampler.downsample(samples);
+    }
+    if (v >= kSettle) y.insert(y.end(), samples.getConstBuffer(), samples.getConstBuffer() + kVectorSize);
+  }
+  return aliasingDb(y, kBin);
+}
+
+// Each doubling of the rate must cut the aliasing by at least 6 dB. First-order ADAA
+// must cut it by at least 6 dB without oversampling, and second order by at least
+// another 3 dB.
+constexpr double kAliasPerFactorDb = -6.0;
+constexpr double kAliasFirstOrderDb = -6.0;
+constexpr double kAliasSecondOrderDb = -3.0;
+
+void checkAliasing(Checker& checker) {
+  const double off = measureAliasing(0, dsp::AdaaOrder::kOff);
+  std::printf("%-52s %12.1f dB\n", "alias/os1", off);
+  double previous = off;
+  for (int factorLog2 = 1; factorLog2 <= dsp::Oversampler<2>::kMaxFactorLog2; ++factorLog2) {
+    const std::string name = "alias/os" + std::to_string(1 << factorLog2) + "/vs-os" + std::to_string(1 << (factorLog2 - 1));
+    const double db = measureAliasing(factorLog2, dsp::AdaaOrder::kOff);
+    if (checker.wants(name)) checker.expect(name, db - previous, kAliasPerFactorDb);
+    previous = db;
+  }
+
+  const double first = measureAliasing(0, dsp::AdaaOrder::kFirst);
+  if (checker.wants("alias/adaa1/vs-off")) checker.expect("alias/adaa1/vs-off", first - off, kAliasFirstOrderDb);
+  if (checker.wants("alias/adaa2/vs-adaa1")) {
+    checker.expect("alias/adaa2/vs-adaa1", measureAliasing(0, dsp::AdaaOrder::kSecond) - first, kAliasSecondOrderDb);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Golden renders
+
+struct Stimulus {
+  const char* name;
+  std::function<float(size_t i, float sampleRate)> sample;
+};
+
+// Every parameter at its default, so a changed default shows up as a changed
+// render rather than silently moving the references
+const ParamSettings kGoldenDefaults = {
+  { "input", 2.2f }, { "output", 0.8f }, { "dry_wet", 1.0f }, { "lowpass", 1500.0f }, { "lowpass_q", 2.2f },
+  { "quality", 1.0f }, { "oversampling", 0.0f }, { "oversampling_mode", 0.0f }, { "adaa", 0.0f },
+  { "bands", 1.0f }, { "crossover_low", 200.0f }, { "crossover_mid", 1000.0f }, { "crossover_high", 5000.0f },
+  { "band1_drive", 1.0f }, { "band2_drive", 1.0f }, { "band3_drive", 1.0f }, { "band4_drive", 1.0f },
+  { "band1_output", 1.0f }, { "band2_output", 1.0f }, { "band3_output", 1.0f }, { "band4_output", 1.0f },
+  { "stereo_mode", 0.0f }, { "lowpass_mode", 0.0f }
+};
+
+// Parameters set on top of kGoldenDefaults. The default preset runs at every drive;
+// the others at the default drive only. ADAA and the nonlinear filter go through
+// exp and log, whose approximations differ between math libraries, so presets
+// using them allow more error.
+struct GoldenPreset {
+  const char* name;
+  ParamSettings params;
+  double tolerance;
+};
+
+const GoldenPreset kGoldenPresets[] = {
+  { "default", {}, 1e-5 },
+  { "os4-adaa2", { { "oversampling", 2.0f }, { "adaa", 2.0f } }, 1e-4 },
+  { "os2-minphase-adaa1", { { "oversampling", 1.0f }, { "oversampling_mode", 1.0f }, { "adaa", 1.0f }, { "quality", 2.0f } }, 1e-4 },
+  { "bands4-midside",
+    { { "bands", 4.0f }, { "crossover_low", 150.0f }, { "crossover_mid", 1200.0f }, { "crossover_high", 6000.0f },
+      { "band1_drive", 1.5f }, { "band2_drive", 0.7f }, { "band3_drive", 1.2f }, { "band4_drive", 2.0f },
+      { "band1_output", 1.0f }, { "band2_output", 1.3f }, { "band3_output", 0.8f }, { "band4_output", 0.6f },
+      { "stereo_mode", 1.0f }, { "lowpass", 6000.0f }, { "lowpass_q", 3.0f }, { "dry_wet", 0.7f },
+      { "quality", 3.0f }, { "oversampling", 1.0f } },
+    1e-4 },
+  { "bands2-mid-nonlinear",
+    { { "bands", 2.0f }, { "crossover_low", 400.0f }, { "stereo_mode", 2.0f }, { "adaa", 2.0f },
+      { "lowpass_mode", 1.0f }, { "lowpass", 300.0f }, { "lowpass_q", 8.0f } },
+    1e-4 }
+};
+
+void checkGolden(Checker& checker) {
+  const CheckOptions& options = checker.options();
+  if (options.goldenDir.empty()) return;
+
+  constexpr float kSampleRate = 48000.0f;
+  constexpr size_t kLength = 12000 / kVectorSize * kVectorSize;
+  const Stimulus stimuli[] = {
+    { "sweep", [](size_t i, float sr) {
+        // Exponential sweep from 20 Hz to 20 kHz over the whole render
+        const double t = i / static_cast<double>(sr), duration = kLength / static_cast<double>(sr);
+        const double rate = std::log(1000.0) / duration;
+        return 0.8f * static_cast<float>(std::sin(2.0 * kPi * 20.0 * (std::exp(rate * t) - 1.0) / rate));
+      } },
+    { "impulse", [](size_t i, float) { return (i % 3000 == 100) ? 1.0f : 0.0f; } },
+    { "noise", [](size_t i, float) {
+        uint32_t seed = static_cast<uint32_t>(i) * 2654435761u + 12345u;
+        seed ^= seed >> 15;
+        seed *= 2246822519u;
+        seed ^= seed >> 13;
+        return static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+      } },
+    { "dc-step", [](size_t i, float) { return (i >= kLength / 4 && i < kLength * 3 / 4) ? 0.5f : 0.0f; } }
+  };
+  const float drives[] = { 0.5f, 2.2f, 5.0f };
+
+  for (const auto& stimulus : stimuli) {
+    std::vector<float> left(kLength), right(kLength);
+    for (size_t i = 0; i < kLength; ++i) {
+      left[i] = stimulus.sample(i, kSampleRate);
+      // The right channel is delayed and attenuated so the two sides differ
+      right[i] = (i >= 37) ? 0.6f * stimulus.sample(i - 37, kSampleRate) : 0.0f;
+    }
+
+    for (const auto& preset : kGoldenPresets) {
+      const bool isDefault = (preset.name == kGoldenPresets[0].name);
+      for (float drive : drives) {
+        if (!isDefault && drive != 2.2f) continue;
+        char driveText[16];
+        std::snprintf(driveText, sizeof(driveText), "%.1f", drive);
+        const std::string prefix = isDefault ? "" : std::string(preset.name) + "/";
+        const std::string name = std::string("golden/") + prefix + stimulus.name + "/drive" + driveText;
+        if (!checker.wants(name)) continue;
+
+        ParamSettings params = kGoldenDefaults;
+        params.insert(params.end(), preset.params.begin(), preset.params.end());
+        params.push_back({ "input", drive });
+        const auto out = renderEffect(params, 2, left, right, kSampleRate);
+        std::vector<float> interleaved(2 * kLength);
+        for (size_t i = 0; i < kLength; ++i) {
+          interleaved[2 * i] = out[0][i];
+          interleaved[2 * i + 1] = out[1][i];
+        }
+
+        const std::string filePrefix = isDefault ? "" : std::string(preset.name) + "-";
+        const std::string path = options.goldenDir + "/" + filePrefix + stimulus.name + "-drive" + driveText + ".f32";
+        if (options.updateGolden) {
+          std::ofstream file(path, std::ios::binary);
+          file.write(reinterpret_cast<const char*>(interleaved.data()), interleaved.size() * sizeof(float));
+          if (!file) {
+            checker.expect(name + " (write)", 1.0, 0.0);
+          } else {
+            std::printf("%-52s %27s  wrote %s\n", name.c_str(), "", path.c_str());
+          }
+          continue;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+          checker.fail(name, "no reference, run with --update-golden");
+          continue;
+        }
+        std::vector<float> reference(interleaved.size());
+        file.read(reinterpret_cast<char*>(reference.data()), reference.size() * sizeof(float));
+        if (file.gcount() != static_cast<std::streamsize>(reference.size() * sizeof(float))) {
+          checker.expect(name + " (length)", 1.0, 0.0);
+          continue;
+        }
+        checker.expect(name, maxDifference(interleaved, reference), preset.tolerance);
+      }
+    }
+  }
+}
+
+} // namespace
+
+int runChecks(const CheckOptions& options) {
+  Checker checker(options);
+  std::printf("%-52s %12s %12s\n", "case", "error", "tolerance");
+  checkTanh(checker);
+  checkAdaa(checker);
+  checkLowpass(checker);
+  checkCoeffTable(checker);
+  checkCrossover(checker);
+  checkPacks(checker);
+  checkStereoModes(checker);
+  checkAliasing(checker);
+  checkGolden(checker);
+
+  if (checker.failures() > 0) {
+    std::printf("\n%d check(s) failed\n", checker.failures());
+  } else {
+    std::printf("\nall checks passed\n");
+  }
+  return checker.failures();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+// Golden-render and fast-path equivalence checks, run by TanhSaturator-bench --check.
+// See TanhSaturator-check.cpp for the cases and their tolerances.
+
+struct CheckOptions {
+  // Directory of reference renders, one raw interleaved float32 file per stimulus.
+  // Empty skips the golden checks; a missing file fails its check.
+  std::string goldenDir;
+
+  // Write the current renders as the new references instead of comparing
+  bool updateGolden = false;
+
+  // Only run cases whose name contains this text
+  std::string filter;
+};
+
+// Runs every check, prints one line per case and returns the number of failures
+int runChecks(const CheckOptions& options);
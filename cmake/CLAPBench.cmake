@@ -0,0 +1,102 @@
+# CLAPBench.cmake - Headless DSP benchmark for the plugin
+# Usage: include(CLAPBench)
+# Note: Requires CLAPPlugin to be included first
+#
+# Builds <plugin>-bench from bench/*.cpp and the plugin's DSP sources, without
+# GUI, host or CLAP entry point. The benchmark writes results as JSON and can
+# compare them against a baseline run, failing on regressions.
+#
+# Available targets:
+# - <plugin>-bench: Build the benchmark executable
+# - bench: Run the benchmark and write bench_results.json to the build directory
+# - bench-compare: Run the benchmark and compare against BENCH_BASELINE
+# - bench-check: Run the golden-render and fast-path equivalence checks
+# - bench-golden: Write the current renders to BENCH_GOLDEN_DIR as the new references
+#
+# CTest tests (enable_testing() in the top-level CMakeLists.txt):
+# - <plugin>-fast-paths: every fast kernel/SIMD path against its double-precision reference
+# - <plugin>-golden: full-effect renders against the references committed in
+#   BENCH_GOLDEN_DIR; rewrite them with bench-golden when the sound changes
+
+set(BENCH_BASELINE "${CMAKE_SOURCE_DIR}/bench/baseline.json" CACHE FILEPATH "Baseline results for bench-compare")
+set(BENCH_THRESHOLD "10" CACHE STRING "Allowed slowdown in percent before bench-compare fails")
+set(BENCH_GOLDEN_DIR "${CMAKE_SOURCE_DIR}/bench/golden" CACHE PATH "Reference renders for bench-check")
+
+# Function to create the benchmark target for a plugin
+function(create_clap_bench TARGET_NAME)
+  set(BENCH_TARGET ${TARGET_NAME}-bench)
+
+  # Plugin processor and DSP sources only; the GUI and entry point are left out
+  file(GLOB BENCH_SOURCES "bench/*.cpp")
+  file(GLOB BENCH_DSP_SOURCES "src/dsp/*.cpp")
+
+  add_executable(${BENCH_TARGET}
+    ${BENCH_SOURCES}
+    ${BENCH_DSP_SOURCES}
+    src/${TARGET_NAME}.cpp
+    src/Trace.cpp
+  )
+
+  target_link_libraries(${BENCH_TARGET} PRIVATE madronalib)
+  if(WIN32)
+    # GetProcessMemoryInfo for --instances
+    target_link_libraries(${BENCH_TARGET} PRIVATE psapi)
+  endif()
+  clap_plugin_include_directories(${BENCH_TARGET})
+  clap_plugin_tracing(${BENCH_TARGET})
+
+  # Benchmarks are only meaningful with optimizations on
+  if(NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
+    message(STATUS "${BENCH_TARGET}: no CMAKE_BUILD_TYPE set, use -DCMAKE_BUILD_TYPE=Release for meaningful numbers")
+  endif()
+
+  set_target_properties(${BENCH_TARGET} PROPERTIES
+    RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/bench
+  )
+
+  add_custom_target(bench
+    COMMAND ${BENCH_TARGET} --out ${CMAKE_BINARY_DIR}/bench_results.json
+    DEPENDS ${BENCH_TARGET}
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    COMMENT "Running DSP benchmarks..."
+    VERBATIM
+  )
+
+  add_custom_target(bench-compare
+    COMMAND ${BENCH_TARGET} --out ${CMAKE_BINARY_DIR}/bench_results.json
+            --compare ${BENCH_BASELINE} --threshold ${BENCH_THRESHOLD}
+    DEPENDS ${BENCH_TARGET}
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    COMMENT "Running DSP benchmarks against ${BENCH_BASELINE}..."
+    VERBATIM
+  )
+
+  add_custom_target(bench-check
+    COMMAND ${BENCH_TARGET} --check --golden ${BENCH_GOLDEN_DIR}
+    DEPENDS ${BENCH_TARGET}
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    COMMENT "Running golden-render and fast-path checks..."
+    VERBATIM
+  )
+
+  add_custom_target(bench-golden
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${BENCH_GOLDEN_DIR}
+    COMMAND ${BENCH_TARGET} --check --golden ${BENCH_GOLDEN_DIR} --update-golden
+    DEPENDS ${BENCH_TARGET}
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    COMMENT "Writing reference renders to ${BENCH_GOLDEN_DIR}..."
+    VERBATIM
+  )
+
+  # Without --golden the golden cases don't run, so the two tests don't overlap
+  add_test(NAME ${TARGET_NAME}-fast-paths
+    COMMAND ${BENCH_TARGET} --check
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+  )
+  add_test(NAME ${TARGET_NAME}-golden
+    COMMAND ${BENCH_TARGET} --check --golden ${BENCH_GOLDEN_DIR} --filter golden/
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+  )
+
+  message(STATUS "Benchmark: ${BENCH_TARGET} (make bench, make bench-compare, make bench-check, ctest)")
+endfunction()
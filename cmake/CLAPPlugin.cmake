@@ -2,6 +2,57 @@
 # Usage: include(CLAPPlugin)
 # Note: Requires PLUGIN_PROJECT_NAME and other metadata variables to be set
 
+# Function to add the madronalib, mlvg and plugin include directories to a target.
+# Shared by the plugin and by headless targets built from the plugin sources.
+function(clap_plugin_include_directories TARGET_NAME)
+  # Set up nanovg include directories
+  set(MLVG_SOURCE_DIR "${CMAKE_CURRENT_SOURCE_DIR}/external/mlvg/source")
+  set(NANOVG_INCLUDE_DIRS
+      ${MLVG_SOURCE_DIR}/external/nanovg/src
+      ${MLVG_SOURCE_DIR}/external/nanosvg/src
+      ${MLVG_SOURCE_DIR}/external/MetalNanoVG/src
+  )
+
+  target_include_directories(${TARGET_NAME} PRIVATE
+    external/madronalib/include
+    external/madronalib/source
+    external/madronalib/source/app
+    external/madronalib/source/DSP
+    external/madronalib/source/matrix
+    external/madronalib/source/networking
+    external/madronalib/source/procs
+    external/madronalib/external/cJSON
+    external/clap-host/clap/include
+    external/madronalib/external/ffft
+    external/madronalib/external/oscpack
+    external/madronalib/external/rtaudio
+    external/madronalib/external/rtmidi
+    external/madronalib/external/sse2neon
+    external/madronalib/external/utf
+    external/mlvg/include
+    external/mlvg/source
+    external/mlvg/source/common
+    external/mlvg/source/native
+    external/mlvg/source/vg
+    external/mlvg/source/widgets
+    external/mlvg/source/external
+    ${NANOVG_INCLUDE_DIRS}
+    src
+    src/dsp
+    src/widgets
+  )
+endfunction()
+
+# Function to build a target's TRACE_SCOPE markers when ENABLE_TRACING is on.
+# See src/Trace.h; with the option off the markers compile to nothing.
+function(clap_plugin_tracing TARGET_NAME)
+  if(ENABLE_TRACING)
+    find_package(Threads REQUIRED)
+    target_compile_definitions(${TARGET_NAME} PRIVATE ENABLE_TRACING=1)
+    target_link_libraries(${TARGET_NAME} PRIVATE Threads::Threads)
+  endif()
+endfunction()
+
 # Function to create a CLAP plugin target
 function(create_clap_plugin TARGET_NAME)
   # Generate CLAP entry point from metadata
@@ -65,8 +116,8 @@ function(create_clap_plugin TARGET_NAME)
   create_resources(external/mlvg/examples/app/resources build/resources/${TARGET_NAME})
 
   # Gather plugin source files
-  file(GLOB PLUGIN_SOURCES "src/*.cpp" "src/widgets/*.cpp")
-  file(GLOB PLUGIN_HEADERS "src/*.h" "src/widgets/*.h")
+  file(GLOB PLUGIN_SOURCES "src/*.cpp" "src/dsp/*.cpp" "src/widgets/*.cpp")
+  file(GLOB PLUGIN_HEADERS "src/*.h" "src/dsp/*.h" "src/widgets/*.h")
   
   # Update include statements in source files to use new header names
   foreach(SOURCE_FILE ${PLUGIN_SOURCES})
@@ -96,46 +147,15 @@ function(create_clap_plugin TARGET_NAME)
   # Link against madronalib and mlvg
   target_link_libraries(${TARGET_NAME} PRIVATE madronalib mlvg)
 
-  # Set up nanovg include directories
-  set(MLVG_SOURCE_DIR "${CMAKE_CURRENT_SOURCE_DIR}/external/mlvg/source")
-  set(NANOVG_INCLUDE_DIRS
-      ${MLVG_SOURCE_DIR}/external/nanovg/src
-      ${MLVG_SOURCE_DIR}/external/nanosvg/src
-      ${MLVG_SOURCE_DIR}/external/MetalNanoVG/src
-  )
-
   # Add include directories
-  target_include_directories(${TARGET_NAME} PRIVATE
-    external/madronalib/include
-    external/madronalib/source
-    external/madronalib/source/app
-    external/madronalib/source/DSP
-    external/madronalib/source/matrix
-    external/madronalib/source/networking
-    external/madronalib/source/procs
-    external/madronalib/external/cJSON
-    external/clap-host/clap/include
-    external/madronalib/external/ffft
-    external/madronalib/external/oscpack
-    external/madronalib/external/rtaudio
-    external/madronalib/external/rtmidi
-    external/madronalib/external/sse2neon
-    external/madronalib/external/utf
-    external/mlvg/include
-    external/mlvg/source
-    external/mlvg/source/common
-    external/mlvg/source/native
-    external/mlvg/source/vg
-    external/mlvg/source/widgets
-    external/mlvg/source/external
-    ${NANOVG_INCLUDE_DIRS}
-    src
-    src/widgets
-  )
+  clap_plugin_include_directories(${TARGET_NAME})
 
   # Enable GUI support
   target_compile_definitions(${TARGET_NAME} PRIVATE HAS_GUI=1)
 
+  # Trace markers, if enabled
+  clap_plugin_tracing(${TARGET_NAME})
+
   # Platform-specific configuration
   if(APPLE)
     set_target_properties(${TARGET_NAME} PROPERTIES
@@ -233,3 +253,34 @@ function(create_clap_plugin TARGET_NAME)
   message(STATUS "Run `make install` to install to system CLAP directories.")
   message(STATUS "Run `make install-clap-user` to install to user CLAP directories.")
 endfunction()
+
+# Function to create the headless batch renderer for a plugin.
+# Builds <plugin>-render from render/*.cpp and the plugin's processor and DSP
+# sources, without GUI, host or CLAP entry point.
+function(create_clap_render TARGET_NAME)
+  set(RENDER_TARGET ${TARGET_NAME}-render)
+
+  file(GLOB RENDER_SOURCES "render/*.cpp")
+  file(GLOB RENDER_HEADERS "render/*.h")
+  file(GLOB RENDER_DSP_SOURCES "src/dsp/*.cpp")
+
+  add_executable(${RENDER_TARGET}
+    ${RENDER_SOURCES}
+    ${RENDER_HEADERS}
+    ${RENDER_DSP_SOURCES}
+    src/${TARGET_NAME}.cpp
+    src/Trace.cpp
+  )
+
+  find_package(Threads REQUIRED)
+  target_link_libraries(${RENDER_TARGET} PRIVATE madronalib Threads::Threads)
+  clap_plugin_include_directories(${RENDER_TARGET})
+  clap_plugin_tracing(${RENDER_TARGET})
+  target_include_directories(${RENDER_TARGET} PRIVATE render)
+
+  set_target_properties(${RENDER_TARGET} PROPERTIES
+    RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/render
+  )
+
+  message(STATUS "Renderer: ${CMAKE_BINARY_DIR}/render/${RENDER_TARGET}")
+endfunction()
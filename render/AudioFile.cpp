@@ -0,0 +1,331 @@
+#include "AudioFile.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace render {
+
+namespace {
+
+// WAV is little-endian, as are all the platforms we build for, so samples are
+// read and written with memcpy. Header fields are assembled bytewise.
+uint32_t readU32(const uint8_t* p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+uint16_t readU16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+
+void putU32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void putU16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+constexpr uint16_t kWavFormatPcm = 1;
+constexpr uint16_t kWavFormatFloat = 3;
+constexpr uint16_t kWavFormatExtensible = 0xFFFE;
+
+// RIFF header, 18-byte fmt chunk, fact chunk and data chunk header
+constexpr size_t kWavHeaderBytes = 12 + 26 + 12 + 8;
+
+int bytesPerSample(SampleFormat format) {
+  switch (format) {
+    case SampleFormat::kInt16: return 2;
+    case SampleFormat::kInt24: return 3;
+    case SampleFormat::kFloat64: return 8;
+    default: return 4;
+  }
+}
+
+inline float readSample(const uint8_t* p, SampleFormat format) {
+  switch (format) {
+    case SampleFormat::kInt16: {
+      int16_t v;
+      std::memcpy(&v, p, 2);
+      return static_cast<float>(v) * (1.0f / 32768.0f);
+    }
+    case SampleFormat::kInt24: {
+      int32_t v = static_cast<int32_t>((uint32_t(p[0]) << 8) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 24)) >> 8;
+      return static_cast<float>(v) * (1.0f / 8388608.0f);
+    }
+    case SampleFormat::kInt32: {
+      int32_t v;
+      std::memcpy(&v, p, 4);
+      return static_cast<float>(v) * (1.0f / 2147483648.0f);
+    }
+    case SampleFormat::kFloat64: {
+      double v;
+      std::memcpy(&v, p, 8);
+      return static_cast<float>(v);
+    }
+    default: {
+      float v;
+      std::memcpy(&v, p, 4);
+      return v;
+    }
+  }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// MappedFile
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+  close();
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    CloseHandle(file);
+    return false;
+  }
+
+  _data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!_data) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  _file = file;
+  _mapping = mapping;
+  _size = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+void MappedFile::close() {
+  if (_data) UnmapViewOfFile(_data);
+  if (_mapping) CloseHandle(static_cast<HANDLE>(_mapping));
+  if (_file) CloseHandle(static_cast<HANDLE>(_file));
+  _data = nullptr;
+  _mapping = _file = nullptr;
+  _size = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+
+  void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    ::close(fd);
+    return false;
+  }
+
+  // The file is streamed front to back exactly once
+  madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+  _fd = fd;
+  _data = static_cast<const uint8_t*>(data);
+  _size = static_cast<size_t>(st.st_size);
+  return true;
+}
+
+void MappedFile::close() {
+  if (_data) munmap(const_cast<uint8_t*>(_data), _size);
+  if (_fd >= 0) ::close(_fd);
+  _data = nullptr;
+  _fd = -1;
+  _size = 0;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// AudioView
+
+void AudioView::read(size_t frame, size_t n, float* left, float* right) const {
+  const int sampleBytes = bytesPerSample(format);
+  const size_t frameBytes = static_cast<size_t>(sampleBytes) * channels;
+  const uint8_t* p = data + frame * frameBytes;
+  for (size_t i = 0; i < n; ++i, p += frameBytes) {
+    left[i] = readSample(p, format);
+    right[i] = (channels > 1) ? readSample(p + sampleBytes, format) : left[i];
+  }
+}
+
+bool parseWav(const MappedFile& file, AudioView& view, std::string& error) {
+  const uint8_t* p = file.data();
+  const size_t size = file.size();
+  if (size < 12 || std::memcmp(p, "RIFF", 4) != 0 || std::memcmp(p + 8, "WAVE", 4) != 0) {
+    error = "not a RIFF/WAVE file";
+    return false;
+  }
+
+  bool haveFormat = false;
+  uint16_t formatTag = 0, bits = 0;
+  size_t pos = 12;
+  while (pos + 8 <= size) {
+    const uint8_t* chunk = p + pos;
+    const size_t chunkSize = readU32(chunk + 4);
+    const size_t available = size - pos - 8;
+
+    if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 && available >= 16) {
+      formatTag = readU16(chunk + 8);
+      view.channels = readU16(chunk + 10);
+      view.sampleRate = static_cast<int>(readU32(chunk + 12));
+      bits = readU16(chunk + 22);
+      if (formatTag == kWavFormatExtensible && chunkSize >= 26 && available >= 26) {
+        // The first two bytes of the subformat GUID are the actual format tag
+        formatTag = readU16(chunk + 32);
+      }
+      haveFormat = true;
+    } else if (std::memcmp(chunk, "data", 4) == 0) {
+      if (!haveFormat) {
+        error = "data chunk before fmt chunk";
+        return false;
+      }
+      if (formatTag == kWavFormatPcm && bits == 16) {
+        view.format = SampleFormat::kInt16;
+      } else if (formatTag == kWavFormatPcm && bits == 24) {
+        view.format = SampleFormat::kInt24;
+      } else if (formatTag == kWavFormatPcm && bits == 32) {
+        view.format = SampleFormat::kInt32;
+      } else if (formatTag == kWavFormatFloat && bits == 32) {
+        view.format = SampleFormat::kFloat32;
+      } else if (formatTag == kWavFormatFloat && bits == 64) {
+        view.format = SampleFormat::kFloat64;
+      } else {
+        error = "unsupported sample format (format " + std::to_string(formatTag) + ", " + std::to_string(bits) + " bits)";
+        return false;
+      }
+      if (view.channels < 1 || view.channels > 2 || view.sampleRate <= 0) {
+        error = "only mono and stereo files are supported";
+        return false;
+      }
+
+      // Streaming writers may leave the size unset, so trust the file length over the header
+      const size_t dataBytes = std::min(chunkSize, available);
+      view.data = chunk + 8;
+      view.frames = dataBytes / (static_cast<size_t>(bytesPerSample(view.format)) * view.channels);
+      return true;
+    }
+
+    // Chunks are padded to an even length
+    pos += 8 + chunkSize + (chunkSize & 1);
+  }
+
+  error = "no data chunk";
+  return false;
+}
+
+bool parseRawFloat(const MappedFile& file, int channels, int sampleRate, AudioView& view, std::string& error) {
+  if (channels < 1 || channels > 2 || sampleRate <= 0) {
+    error = "raw input needs one or two channels and a sample rate";
+    return false;
+  }
+  view.data = file.data();
+  view.channels = channels;
+  view.sampleRate = sampleRate;
+  view.format = SampleFormat::kFloat32;
+  view.frames = file.size() / (sizeof(float) * channels);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// AudioWriter
+
+bool AudioWriter::open(const std::string& path, bool wav, int channels, int sampleRate) {
+  close();
+  _file = std::fopen(path.c_str(), "wb");
+  if (!_file) return false;
+
+  _wav = wav;
+  _channels = channels;
+  _dataBytes = 0;
+  _ok = true;
+  _buffer.clear();
+  _buffer.reserve(kBufferBytes / sizeof(float));
+
+  if (_wav) {
+    uint8_t header[kWavHeaderBytes] = {};
+    std::memcpy(header, "RIFF", 4);
+    std::memcpy(header + 8, "WAVE", 4);
+    std::memcpy(header + 12, "fmt ", 4);
+    putU32(header + 16, 18);
+    putU16(header + 20, kWavFormatFloat);
+    putU16(header + 22, static_cast<uint16_t>(channels));
+    putU32(header + 24, static_cast<uint32_t>(sampleRate));
+    putU32(header + 28, static_cast<uint32_t>(sampleRate * channels * 4));
+    putU16(header + 32, static_cast<uint16_t>(channels * 4));
+    putU16(header + 34, 32);
+    std::memcpy(header + 38, "fact", 4);
+    putU32(header + 42, 4);
+    std::memcpy(header + 50, "data", 4);
+    _ok = std::fwrite(header, 1, sizeof(header), _file) == sizeof(header);
+  }
+  return _ok;
+}
+
+bool AudioWriter::write(const float* left, const float* right, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    _buffer.push_back(left[i]);
+    if (_channels > 1) _buffer.push_back(right[i]);
+    if (_buffer.size() == _buffer.capacity()) flush();
+  }
+  return _ok;
+}
+
+bool AudioWriter::flush() {
+  if (!_buffer.empty()) {
+    size_t bytes = _buffer.size() * sizeof(float);
+    _ok = _ok && std::fwrite(_buffer.data(), 1, bytes, _file) == bytes;
+    _dataBytes += bytes;
+    _buffer.clear();
+  }
+  return _ok;
+}
+
+bool AudioWriter::close() {
+  if (!_file) return _ok;
+  flush();
+
+  if (_wav) {
+    // Patch the RIFF, fact and data sizes now that the length is known
+    uint8_t size[4];
+    const uint32_t dataBytes = static_cast<uint32_t>(std::min<uint64_t>(_dataBytes, 0xFFFFFFFFu - kWavHeaderBytes));
+    putU32(size, dataBytes + static_cast<uint32_t>(kWavHeaderBytes) - 8);
+    _ok = _ok && std::fseek(_file, 4, SEEK_SET) == 0 && std::fwrite(size, 1, 4, _file) == 4;
+    putU32(size, dataBytes / (4u * static_cast<uint32_t>(_channels)));
+    _ok = _ok && std::fseek(_file, 46, SEEK_SET) == 0 && std::fwrite(size, 1, 4, _file) == 4;
+    putU32(size, dataBytes);
+    _ok = _ok && std::fseek(_file, 54, SEEK_SET) == 0 && std::fwrite(size, 1, 4, _file) == 4;
+  }
+
+  _ok = (std::fclose(_file) == 0) && _ok;
+  _file = nullptr;
+  return _ok;
+}
+
+} // namespace render
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// File I/O for the offline renderer: memory-mapped input and buffered output
+// of WAV (PCM 16/24/32-bit, 32/64-bit float) and raw interleaved 32-bit float.
+// Every format is converted to float on read; the effect has no 64-bit path.
+namespace render {
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile() { close(); }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool open(const std::string& path);
+  void close();
+
+  const uint8_t* data() const { return _data; }
+  size_t size() const { return _size; }
+
+private:
+  const uint8_t* _data = nullptr;
+  size_t _size = 0;
+#ifdef _WIN32
+  void* _file = nullptr;
+  void* _mapping = nullptr;
+#else
+  int _fd = -1;
+#endif
+};
+
+enum class SampleFormat { kInt16, kInt24, kInt32, kFloat32, kFloat64 };
+
+// Interleaved sample frames inside a mapped file
+struct AudioView {
+  const uint8_t* data = nullptr;
+  size_t frames = 0;
+  int channels = 0;
+  int sampleRate = 0;
+  SampleFormat format = SampleFormat::kFloat32;
+
+  // Deinterleave n frames starting at frame into one float buffer per channel
+  // (at most 2). Mono input is copied to both outputs.
+  void read(size_t frame, size_t n, float* left, float* right) const;
+};
+
+// Locate the sample data in a mapped WAV file. Returns false with a message in error
+// for anything that is not a PCM or float WAV with one or two channels.
+bool parseWav(const MappedFile& file, AudioView& view, std::string& error);
+
+// Raw interleaved 32-bit float, in host byte order
+bool parseRawFloat(const MappedFile& file, int channels, int sampleRate, AudioView& view, std::string& error);
+
+// Buffered writer of interleaved 32-bit float frames, as a float WAV or raw file.
+// The WAV header is written with placeholder sizes and patched in close().
+class AudioWriter {
+public:
+  static constexpr size_t kBufferBytes = 1 << 20;
+
+  ~AudioWriter() { close(); }
+
+  bool open(const std::string& path, bool wav, int channels, int sampleRate);
+  bool write(const float* left, const float* right, size_t n);
+  bool close();
+
+private:
+  FILE* _file = nullptr;
+  bool _wav = false;
+  int _channels = 0;
+  uint64_t _dataBytes = 0;
+  std::vector<float> _buffer;
+  bool _ok = true;
+
+  bool flush();
+};
+
+} // namespace render
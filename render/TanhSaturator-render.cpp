@@ -0,0 +1,358 @@
+// TanhSaturator-render - headless batch renderer
+//
+// Streams audio files through TanhSaturator::processVector without a host.
+// Inputs are memory-mapped, outputs are buffered, and files are spread across
+// a pool of worker threads with one processor instance per thread.
+//
+// Usage:
+//   TanhSaturator-render --out-dir DIR [options] input...
+//
+// Options:
+//   --out-dir DIR       directory for rendered files, named after their inputs
+//   --preset FILE       parameter values, one "name = value" per line, # comments
+//   --set NAME=VALUE    set one parameter, applied after the preset
+//   --list FILE         read input paths from FILE, one per line
+//   --jobs N            worker threads (default: hardware concurrency)
+//   --raw               inputs are raw interleaved 32-bit float, not WAV
+//   --channels N        channels of raw input (default 2)
+//   --rate HZ           sample rate of raw input (default 48000)
+//   --tail              append the effect's tail after the end of each file
+//   --no-latency-compensation
+//                       keep the effect's latency instead of trimming it
+//
+// WAV inputs are written as 32-bit float WAV, raw inputs as raw float.
+// Mono inputs are processed as dual mono and written back as mono.
+// Nothing is rendered if an output would overwrite an input or two inputs
+// would be written to the same output.
+
+#include "AudioFile.h"
+#include "TanhSaturator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int kVectorSize = static_cast<int>(ml::kFloatsPerDSPVector);
+
+// Frames read, processed and handed to the writer at a time
+constexpr size_t kChunkFrames = 256 * kVectorSize;
+
+using ParamSettings = std::vector<std::pair<std::string, float>>;
+
+struct Options {
+  std::string outDir;
+  std::vector<std::string> inputs;
+  ParamSettings params;
+  int jobs = 0;
+  bool raw = false;
+  int rawChannels = 2;
+  int rawRate = 48000;
+  bool tail = false;
+  bool compensateLatency = true;
+};
+
+// Exposes parameter setting, which CLAPSignalProcessor keeps protected
+class RenderSaturator : public TanhSaturator {
+public:
+  void setParam(const std::string& name, float value) { _params.setFromRealValue(ml::Path(name.c_str()), value); }
+};
+
+std::mutex gLogMutex;
+
+void logError(const std::string& path, const std::string& message) {
+  std::lock_guard<std::mutex> lock(gLogMutex);
+  std::fprintf(stderr, "%s: %s\n", path.c_str(), message.c_str());
+}
+
+std::string trim(const std::string& s) {
+  auto begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) return "";
+  auto end = s.find_last_not_of(" \t\r\n");
+  return s.substr(begin, end - begin + 1);
+}
+
+// Parses "name = value" or "name=value" into settings, checking the name
+bool parseSetting(const std::string& text, ParamSettings& settings, std::string& error) {
+  auto eq = text.find('=');
+  if (eq == std::string::npos) {
+    error = "expected name = value";
+    return false;
+  }
+  std::string name = trim(text.substr(0, eq));
+  std::string value = trim(text.substr(eq + 1));
+  if (!TanhSaturator::isParamName(name.c_str())) {
+    error = "unknown parameter \"" + name + "\"";
+    return false;
+  }
+  char* end = nullptr;
+  float v = std::strtof(value.c_str(), &end);
+  if (value.empty() || *end != '\0') {
+    error = "bad value \"" + value + "\" for " + name;
+    return false;
+  }
+  settings.emplace_back(name, v);
+  return true;
+}
+
+bool readPreset(const std::string& path, ParamSettings& settings) {
+  std::ifstream in(path);
+  if (!in) {
+    logError(path, "could not open preset");
+    return false;
+  }
+  std::string line, error;
+  for (int lineNumber = 1; std::getline(in, line); ++lineNumber) {
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty()) continue;
+    if (!parseSetting(line, settings, error)) {
+      logError(path + ":" + std::to_string(lineNumber), error);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool readList(const std::string& path, std::vector<std::string>& inputs) {
+  std::ifstream in(path);
+  if (!in) {
+    logError(path, "could not open list");
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    line = trim(line);
+    if (!line.empty()) inputs.push_back(line);
+  }
+  return true;
+}
+
+std::string baseName(const std::string& path) {
+  auto slash = path.find_last_of("/\\");
+  return (slash == std::string::npos) ? path : path.substr(slash + 1);
+}
+
+// The path with symlinks and . and .. resolved as far as it exists, for comparing
+// paths that may not exist yet
+std::string canonicalPath(const std::string& path) {
+  std::error_code error;
+  const std::filesystem::path absolute = std::filesystem::absolute(path, error).lexically_normal();
+  const std::filesystem::path canonical = std::filesystem::weakly_canonical(absolute, error);
+  return error ? absolute.string() : canonical.string();
+}
+
+// Output path for every input, in the same order. Fails, logging every conflict,
+// if an output would overwrite any input or two inputs share an output.
+bool planOutputs(const Options& options, std::vector<std::string>& outPaths) {
+  std::set<std::string> inputs;
+  for (const auto& inPath : options.inputs) inputs.insert(canonicalPath(inPath));
+
+  std::map<std::string, std::string> writers;  // canonical output -> input
+  bool ok = true;
+  for (const auto& inPath : options.inputs) {
+    const std::string outPath = (std::filesystem::path(options.outDir) / baseName(inPath)).string();
+    const std::string canonical = canonicalPath(outPath);
+    std::error_code error;
+    if (inputs.count(canonical) || std::filesystem::equivalent(inPath, outPath, error)) {
+      logError(inPath, "output " + outPath + " would overwrite an input");
+      ok = false;
+    } else if (!writers.emplace(canonical, inPath).second) {
+      logError(inPath, "output " + outPath + " is also the output of " + writers[canonical]);
+      ok = false;
+    }
+    outPaths.push_back(outPath);
+  }
+  return ok;
+}
+
+// Renders one file. Returns the length of the input in seconds, or -1 on failure.
+double renderFile(RenderSaturator& processor, const std::string& inPath, const std::string& outPath,
+                  const Options& options) {
+  render::MappedFile file;
+  if (!file.open(inPath)) {
+    logError(inPath, "could not open or map input");
+    return -1;
+  }
+
+  render::AudioView view;
+  std::string error;
+  bool parsed = options.raw ? render::parseRawFloat(file, options.rawChannels, options.rawRate, view, error)
+                            : render::parseWav(file, view, error);
+  if (!parsed) {
+    logError(inPath, error);
+    return -1;
+  }
+
+  render::AudioWriter writer;
+  if (!writer.open(outPath, !options.raw, view.channels, view.sampleRate)) {
+    logError(outPath, "could not open output");
+    return -1;
+  }
+
+  // Start every file from silence with parameters settled
+  processor.setSampleRate(view.sampleRate);
+  processor.resetProcessingState();
+
+  // Trim the effect's latency from the start and render that many extra frames at the end
+  const size_t latency = options.compensateLatency ? processor.getLatencySamples() : 0;
+  const size_t tail = options.tail ? processor.getTailSamples() : 0;
+  const size_t totalFrames = view.frames + latency + tail;
+
+  std::vector<float> inL(kChunkFrames), inR(kChunkFrames), outL(kChunkFrames), outR(kChunkFrames);
+  ml::DSPVectorDynamic inputs(2), outputs(2);
+  size_t skip = latency;
+
+  for (size_t frame = 0; frame < totalFrames; frame += kChunkFrames) {
+    const size_t n = std::min(kChunkFrames, totalFrames - frame);
+    const size_t nInput = (frame < view.frames) ? std::min(n, view.frames - frame) : 0;
+    view.read(frame, nInput, inL.data(), inR.data());
+    std::fill(inL.begin() + nInput, inL.end(), 0.0f);
+    std::fill(inR.begin() + nInput, inR.end(), 0.0f);
+
+    // n may end partway through a vector; the remainder is processed as silence and dropped
+    for (size_t v = 0; v < n; v += kVectorSize) {
+      std::copy(inL.begin() + v, inL.begin() + v + kVectorSize, inputs[0].getBuffer());
+      std::copy(inR.begin() + v, inR.begin() + v + kVectorSize, inputs[1].getBuffer());
+      processor.processVector(inputs, outputs, nullptr);
+      std::copy(outputs[0].getConstBuffer(), outputs[0].getConstBuffer() + kVectorSize, outL.begin() + v);
+      std::copy(outputs[1].getConstBuffer(), outputs[1].getConstBuffer() + kVectorSize, outR.begin() + v);
+    }
+
+    const size_t skipHere = std::min(skip, n);
+    skip -= skipHere;
+    writer.write(outL.data() + skipHere, outR.data() + skipHere, n - skipHere);
+  }
+
+  if (!writer.close()) {
+    logError(outPath, "write failed");
+    return -1;
+  }
+  return static_cast<double>(view.frames) / view.sampleRate;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  std::vector<std::string> overrides;
+  std::string presetPath;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--out-dir" && hasValue) {
+      options.outDir = argv[++i];
+    } else if (arg == "--preset" && hasValue) {
+      presetPath = argv[++i];
+    } else if (arg == "--set" && hasValue) {
+      overrides.push_back(argv[++i]);
+    } else if (arg == "--list" && hasValue) {
+      if (!readList(argv[++i], options.inputs)) return false;
+    } else if (arg == "--jobs" && hasValue) {
+      options.jobs = std::atoi(argv[++i]);
+    } else if (arg == "--raw") {
+      options.raw = true;
+    } else if (arg == "--channels" && hasValue) {
+      options.rawChannels = std::atoi(argv[++i]);
+    } else if (arg == "--rate" && hasValue) {
+      options.rawRate = std::atoi(argv[++i]);
+    } else if (arg == "--tail") {
+      options.tail = true;
+    } else if (arg == "--no-latency-compensation") {
+      options.compensateLatency = false;
+    } else if (!arg.empty() && arg[0] != '-') {
+      options.inputs.push_back(arg);
+    } else {
+      std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+      return false;
+    }
+  }
+
+  if (!presetPath.empty() && !readPreset(presetPath, options.params)) return false;
+  for (const auto& text : overrides) {
+    std::string error;
+    if (!parseSetting(text, options.params, error)) {
+      logError("--set " + text, error);
+      return false;
+    }
+  }
+
+  if (options.outDir.empty() || options.inputs.empty()) {
+    std::fprintf(stderr,
+                 "usage: %s --out-dir DIR [--preset FILE] [--set NAME=VALUE] [--list FILE] [--jobs N]\n"
+                 "          [--raw [--channels N] [--rate HZ]] [--tail] [--no-latency-compensation] input...\n",
+                 argv[0]);
+    return false;
+  }
+  return true;
+}
+
+// Everything main() does before shutting the tracer down
+int run(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) return 2;
+
+  std::vector<std::string> outPaths;
+  if (!planOutputs(options, outPaths)) return 2;
+
+  int jobs = options.jobs > 0 ? options.jobs : static_cast<int>(std::thread::hardware_concurrency());
+  jobs = std::max(1, std::min(jobs, static_cast<int>(options.inputs.size())));
+
+  std::atomic<size_t> nextFile{ 0 };
+  std::atomic<int> failures{ 0 };
+  std::atomic<double> secondsRendered{ 0.0 };
+  auto start = std::chrono::steady_clock::now();
+
+  // Each worker owns one processor and pulls files from the shared list until it is empty
+  auto worker = [&]() {
+    RenderSaturator processor;
+    for (const auto& param : options.params) {
+      processor.setParam(param.first, param.second);
+    }
+
+    for (size_t i = nextFile++; i < options.inputs.size(); i = nextFile++) {
+      double seconds = renderFile(processor, options.inputs[i], outPaths[i], options);
+      if (seconds < 0.0) {
+        ++failures;
+        continue;
+      }
+      double expected = secondsRendered.load();
+      while (!secondsRendered.compare_exchange_weak(expected, expected + seconds)) {
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < jobs; ++t) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::printf("rendered %zu file(s), %.1f s of audio in %.2f s (%.0fx realtime) on %d thread(s)\n",
+              options.inputs.size() - failures.load(), secondsRendered.load(), wallSeconds,
+              secondsRendered.load() / std::max(wallSeconds, 1e-9), jobs);
+  if (failures > 0) {
+    std::printf("%d file(s) failed\n", failures.load());
+    return 1;
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const int result = run(argc, argv);
+  // Completes the trace file in builds with ENABLE_TRACING
+  trace::shutdown();
+  return result;
+}
@@ -49,8 +49,16 @@ def get_clap_features(metadata):
     else:
         features.append("CLAP_PLUGIN_FEATURE_SYNTHESIZER")  # default
     
-    # Always add stereo for this template
-    features.append("CLAP_PLUGIN_FEATURE_STEREO")
+    # Channel layouts the plugin offers, stereo if not listed
+    channel_features = {
+        "mono": "CLAP_PLUGIN_FEATURE_MONO",
+        "stereo": "CLAP_PLUGIN_FEATURE_STEREO",
+        "surround": "CLAP_PLUGIN_FEATURE_SURROUND",
+        "ambisonic": "CLAP_PLUGIN_FEATURE_AMBISONIC",
+    }
+    for layout in metadata.get("channel_layouts", ["stereo"]):
+        if layout in channel_features:
+            features.append(channel_features[layout])
     
     return features
 
@@ -78,6 +86,8 @@ def generate_entry_point(metadata):
     
     template = f'''#include "{metadata["project_name"]}.h"
 #include "{metadata["project_name"]}-gui.h"
+#include "PluginExtensions.h"
+#include "Trace.h"
 #include <CLAPExport.h>
 
 extern "C" {{
@@ -112,7 +122,7 @@ extern "C" {{
     if (strcmp(plugin_id, desc.id) != 0) {{
       return nullptr;
     }}
-    return new ml::CLAPPluginWrapper<{class_name}, {gui_class_name}>(host, &desc);
+    return new PluginExtensions<{class_name}, {gui_class_name}>(host, &desc);
   }}
   
   static const clap_plugin_factory plugin_factory = {{
@@ -128,7 +138,7 @@ extern "C" {{
   const CLAP_EXPORT clap_plugin_entry clap_entry = {{
     CLAP_VERSION_INIT,
     [](const char* path) -> bool {{ return true; }},
-    []() {{}},
+    []() {{ trace::shutdown(); }},
     [](const char* factory_id) -> const void* {{
       return strcmp(factory_id, CLAP_PLUGIN_FACTORY_ID) == 0 ? &plugin_factory : nullptr;
     }}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "MLDSPOps.h"
+#include "SpscRing.h"
+#include "dsp/Oversampler.h"
+#include "dsp/VectorOps.h"
+#include <array>
+#include <atomic>
+#include <memory>
+
+// Audio-thread side of the GUI analyzer. While enabled, it mixes the output to
+// mono, decimates it by halfband stages to about kAnalysisRate, and hands it to
+// the GUI through a wait-free ring. Each block carries a snapshot of the settings
+// the analyzer needs to draw the transfer curve and the filter response. Like the
+// telemetry ring, the analyzer's is allocated when a GUI first enables it.
+// FFTs and drawing happen on the GUI thread; see widgets/AnalyzerWidget.h.
+
+// Settings shown by the analyzer, sampled once per block
+struct AnalyzerSettings {
+  float inputGain = 1.0f;
+  float outputGain = 1.0f;
+  float lowpassHz = 1000.0f;
+  float lowpassQ = 0.707f;
+  bool filterActive = true;
+  int quality = 1;
+};
+
+struct AnalyzerBlock {
+  AnalyzerSettings settings;
+  float hostSampleRate = 48000.0f;
+  float sampleRate = 48000.0f;  // rate of samples[] after decimation
+  float inputPeak = 0.0f;       // before input gain
+  int size = 0;
+  float samples[ml::kFloatsPerDSPVector] = {};
+};
+
+class AnalyzerTap {
+public:
+  // Audio above this rate is decimated by 2 until it is at or below it
+  static constexpr float kAnalysisRate = 64000.0f;
+  static constexpr int kMaxDecimationLog2 = 2;
+  static constexpr size_t kCapacity = 256;
+  static constexpr int kDecimatorHalfOrder = 8;
+  using Ring = SpscRing<AnalyzerBlock, kCapacity>;
+
+  // GUI thread
+  void setEnabled(bool enabled) {
+    if (enabled && !_ringStorage) {
+      _ringStorage = std::make_unique<Ring>();
+      _ring.store(_ringStorage.get(), std::memory_order_release);
+    }
+    _enabled.store(enabled, std::memory_order_relaxed);
+  }
+  bool pop(AnalyzerBlock& block) { return _ringStorage && _ringStorage->pop(block); }
+
+  // Audio thread
+  bool isEnabled() const {
+    return _enabled.load(std::memory_order_relaxed) && _ring.load(std::memory_order_acquire);
+  }
+
+  void write(const ml::DSPVector& leftInput, const ml::DSPVector& rightInput,
+             const ml::DSPVector& leftOutput, const ml::DSPVector& rightOutput,
+             float sampleRate, const AnalyzerSettings& settings) {
+    if (sampleRate != _block.hostSampleRate || !_wasEnabled) {
+      configure(sampleRate);
+    }
+    _wasEnabled = true;
+
+    // Mono output, decimated in place through the ping-pong buffers
+    ml::DSPVector mono = (leftOutput + rightOutput) * ml::DSPVector(0.5f);
+    const float* src = mono.getConstBuffer();
+    int n = static_cast<int>(ml::kFloatsPerDSPVector);
+    for (int s = 0; s < _decimationLog2; ++s) {
+      float* dst = _scratch[s & 1].data();
+      n /= 2;
+      decimator().downsample(_history[s].data(), src, dst, n);
+      src = dst;
+    }
+
+    _block.settings = settings;
+    _block.inputPeak = std::max(dsp::peakAbs(leftInput), dsp::peakAbs(rightInput));
+    _block.size = n;
+    std::copy(src, src + n, _block.samples);
+    _ring.load(std::memory_order_relaxed)->push(_block);
+  }
+
+  // Audio thread, when disabled: the next enabled block starts from clean filter state
+  void skip() { _wasEnabled = false; }
+
+private:
+  std::atomic<bool> _enabled{ false };
+  bool _wasEnabled = false;
+  int _decimationLog2 = 0;
+  // Decimator state per stage; the largest block is a full DSPVector in, half out
+  std::array<std::array<float, 4 * kDecimatorHalfOrder + ml::kFloatsPerDSPVector>, kMaxDecimationLog2> _history{};
+  std::array<std::array<float, ml::kFloatsPerDSPVector / 2>, 2> _scratch{};
+  AnalyzerBlock _block;
+  // Owned by the GUI thread and kept until destruction once allocated
+  std::unique_ptr<Ring> _ringStorage;
+  std::atomic<Ring*> _ring{ nullptr };
+
+  void configure(float sampleRate) {
+    _decimationLog2 = 0;
+    float rate = sampleRate;
+    while (rate > kAnalysisRate && _decimationLog2 < kMaxDecimationLog2) {
+      rate *= 0.5f;
+      ++_decimationLog2;
+    }
+    for (auto& history : _history) history.fill(0.0f);
+    _block.hostSampleRate = sampleRate;
+    _block.sampleRate = rate;
+  }
+
+  // One design shared by every stage of every instance
+  static const dsp::HalfbandFir& decimator() {
+    static const dsp::HalfbandFir fir = [] {
+      dsp::HalfbandFir design;
+      design.design(kDecimatorHalfOrder, 7.0f);
+      return design;
+    }();
+    return fir;
+  }
+};
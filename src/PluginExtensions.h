@@ -0,0 +1,343 @@
+#pragma once
+
+#include "../external/madronalib/include/CLAPExport.h"  // ml::CLAPPluginWrapper and the CLAP headers
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// CLAP extensions the madronalib wrapper doesn't provide, added around it:
+//
+//   latency   Processor::getLatencySamples(). The value is reported to the host
+//             when the plugin is activated. If it changes while the plugin is
+//             active, the processor asks for a restart from the audio thread.
+//   tail      Processor::getCurrentTailSamples(), which the processor updates when
+//             the settings change, telling the host from the audio thread.
+//   audio-ports, audio-ports-config
+//             One main input and one main output with Processor::getChannelCount()
+//             channels each. The host picks a layout from Processor::kChannelConfigs,
+//             identified by index, and selecting one sets the processor's channel count.
+//
+// The processor can also ask for a main-thread callback, which arrives as
+// Processor::onMainThread() after the wrapper's own on_main_thread.
+//
+// Parameter changes are tracked for Processor::setParamEventTracking(): value
+// events in process() and params.flush(), in either direction, mark their
+// parameter, and activation and state.load() mark all of them. Tracking is only
+// turned on when every processor parameter has an id in the wrapper's params
+// extension. Changes that reach the processor without an event are still picked
+// up by its slow sweep.
+//
+// PluginExtensions derives from the wrapper only to keep this state next to it.
+// Its constructor swaps in clap_plugin callbacks that do the extra work and then
+// call the wrapper's own, kept in _wrapped. Of the extensions the wrapper
+// provides, params and state are copied with flush and load wrapped the same way;
+// the others are passed through unchanged.
+//
+// The wrapper creates the processor itself, in its constructor or in init(). It
+// is given ClaimedProcessor, which registers with the ProcessorClaim of the
+// PluginExtensions being constructed or initialized on the calling thread, so
+// each instance gets the processor its own wrapper created and no other.
+template <class Processor>
+class ProcessorClaim {
+protected:
+  // Opens the claim for the processor created during construction
+  ProcessorClaim() { tOpenClaim = this; }
+
+  // Runs f with the claim open, for a wrapper call that may create the processor
+  template <class F>
+  auto withClaimOpen(F&& f) {
+    ProcessorClaim* previous = tOpenClaim;
+    tOpenClaim = this;
+    auto result = f();
+    tOpenClaim = previous;
+    return result;
+  }
+
+  void closeClaim() { tOpenClaim = nullptr; }
+
+  Processor* _processor = nullptr;
+
+public:
+  class ClaimedProcessor : public Processor {
+  public:
+    ClaimedProcessor() {
+      if (tOpenClaim && !tOpenClaim->_processor) tOpenClaim->_processor = this;
+    }
+  };
+
+private:
+  static inline thread_local ProcessorClaim* tOpenClaim = nullptr;
+};
+
+template <class Processor, class GUI>
+class PluginExtensions : private ProcessorClaim<Processor>,
+                         public ml::CLAPPluginWrapper<typename ProcessorClaim<Processor>::ClaimedProcessor, GUI> {
+  using Claim = ProcessorClaim<Processor>;
+  using Wrapper = ml::CLAPPluginWrapper<typename Claim::ClaimedProcessor, GUI>;
+  using Claim::_processor;
+
+public:
+  PluginExtensions(const clap_host* host, const clap_plugin_descriptor* descriptor)
+      : Claim(), Wrapper(host, descriptor), _host(host) {
+    this->closeClaim();
+    clap_plugin& plugin = *this;
+    _wrapped = plugin;
+    plugin.init = init;
+    plugin.destroy = destroy;
+    plugin.activate = activate;
+    plugin.get_extension = getExtension;
+    plugin.on_main_thread = onMainThread;
+    plugin.process = process;
+  }
+
+private:
+  const clap_host* _host;
+  clap_plugin _wrapped;
+  const clap_host_latency* _hostLatency = nullptr;
+  const clap_host_tail* _hostTail = nullptr;
+  uint32_t _reportedLatency = 0;
+
+  // The wrapper's params and state extensions, and the copies handed to the host
+  const clap_plugin_params* _wrappedParams = nullptr;
+  const clap_plugin_state* _wrappedState = nullptr;
+  clap_plugin_params _params{};
+  clap_plugin_state _state{};
+
+  // Wrapper parameter id and processor parameter index of each tracked parameter
+  std::vector<std::pair<clap_id, int>> _paramIds;
+  bool _paramTracking = false;
+
+  // Output event list that marks parameter events on their way to the host's list
+  struct TrackedOutput {
+    clap_output_events events;
+    const clap_output_events* target;
+    PluginExtensions* owner;
+
+    TrackedOutput(PluginExtensions* owner, const clap_output_events* target)
+        : events{ this, tryPush }, target(target), owner(owner) {}
+    TrackedOutput(const TrackedOutput&) = delete;
+    TrackedOutput& operator=(const TrackedOutput&) = delete;
+
+    static bool tryPush(const clap_output_events* list, const clap_event_header* event) {
+      const TrackedOutput& output = *static_cast<const TrackedOutput*>(list->ctx);
+      output.owner->markParamEvent(event);
+      return output.target->try_push(output.target, event);
+    }
+  };
+
+  static PluginExtensions& self(const clap_plugin* plugin) {
+    return *static_cast<PluginExtensions*>(const_cast<clap_plugin*>(plugin));
+  }
+
+  static bool init(const clap_plugin* plugin) {
+    PluginExtensions& p = self(plugin);
+    if (!p.withClaimOpen([&] { return p._wrapped.init(plugin); })) return false;
+    if (p._processor) p._processor->setHostRequestCallback(onHostRequest, &p);
+    p._hostLatency = static_cast<const clap_host_latency*>(p._host->get_extension(p._host, CLAP_EXT_LATENCY));
+    p._hostTail = static_cast<const clap_host_tail*>(p._host->get_extension(p._host, CLAP_EXT_TAIL));
+
+    p._wrappedParams = static_cast<const clap_plugin_params*>(p._wrapped.get_extension(plugin, CLAP_EXT_PARAMS));
+    p._wrappedState = static_cast<const clap_plugin_state*>(p._wrapped.get_extension(plugin, CLAP_EXT_STATE));
+    if (p._wrappedParams) {
+      p._params = *p._wrappedParams;
+      p._params.flush = flushParams;
+    }
+    if (p._wrappedState) {
+      p._state = *p._wrappedState;
+      p._state.load = loadState;
+    }
+    p._paramTracking = p._processor && p.mapParamIds(plugin);
+    if (p._processor) p._processor->setParamEventTracking(p._paramTracking);
+    return true;
+  }
+
+  // Main thread. True if every processor parameter has a wrapper id.
+  bool mapParamIds(const clap_plugin* plugin) {
+    if (!_wrappedParams) return false;
+    uint64_t mapped = 0;
+    const uint32_t count = _wrappedParams->count(plugin);
+    for (uint32_t i = 0; i < count; ++i) {
+      clap_param_info info;
+      if (!_wrappedParams->get_info(plugin, i, &info)) continue;
+      const int index = Processor::paramIndex(info.name);
+      if (index < 0) continue;
+      _paramIds.emplace_back(info.id, index);
+      mapped |= uint64_t(1) << index;
+    }
+    return mapped == (uint64_t(1) << Processor::getNumParams()) - 1;
+  }
+
+  // Audio or main thread
+  void markParamEvent(const clap_event_header* event) {
+    if (event->space_id != CLAP_CORE_EVENT_SPACE_ID) return;
+    if (event->type != CLAP_EVENT_PARAM_VALUE && event->type != CLAP_EVENT_PARAM_MOD) return;
+    // Value and modulation events both start with the header and the param id
+    const clap_id id = reinterpret_cast<const clap_event_param_value*>(event)->param_id;
+    for (const auto& param : _paramIds) {
+      if (param.first == id) {
+        _processor->markParamChanged(param.second);
+        return;
+      }
+    }
+  }
+
+  void markParamEvents(const clap_input_events* events) {
+    if (!events) return;
+    const uint32_t count = events->size(events);
+    for (uint32_t i = 0; i < count; ++i) markParamEvent(events->get(events, i));
+  }
+
+  // Audio thread
+  static clap_process_status process(const clap_plugin* plugin, const clap_process* process) {
+    PluginExtensions& p = self(plugin);
+    if (!p._paramTracking || !process->out_events) return p._wrapped.process(plugin, process);
+    p.markParamEvents(process->in_events);
+    TrackedOutput output(&p, process->out_events);
+    clap_process tracked = *process;
+    tracked.out_events = &output.events;
+    return p._wrapped.process(plugin, &tracked);
+  }
+
+  // Audio or main thread, never both at once
+  static void flushParams(const clap_plugin* plugin, const clap_input_events* in, const clap_output_events* out) {
+    PluginExtensions& p = self(plugin);
+    if (!p._paramTracking || !out) {
+      p._wrappedParams->flush(plugin, in, out);
+      return;
+    }
+    p.markParamEvents(in);
+    TrackedOutput output(&p, out);
+    p._wrappedParams->flush(plugin, in, &output.events);
+  }
+
+  // Main thread
+  static bool loadState(const clap_plugin* plugin, const clap_istream* stream) {
+    PluginExtensions& p = self(plugin);
+    const bool loaded = p._wrappedState->load(plugin, stream);
+    if (p._processor) p._processor->markAllParamsChanged();
+    return loaded;
+  }
+
+  static void destroy(const clap_plugin* plugin) {
+    // Without a virtual destructor the wrapper's destroy would leave this part
+    // undestroyed, so delete through the most derived type instead
+    if constexpr (std::has_virtual_destructor_v<Wrapper>) {
+      self(plugin)._wrapped.destroy(plugin);
+    } else {
+      delete &self(plugin);
+    }
+  }
+
+  static bool activate(const clap_plugin* plugin, double sampleRate, uint32_t minFrames, uint32_t maxFrames) {
+    PluginExtensions& p = self(plugin);
+    if (p._processor) {
+      // The latency may only change while activating; a restart requested from
+      // the audio thread ends up here
+      const uint32_t latency = p._processor->getLatencySamples();
+      if (latency != p._reportedLatency) {
+        p._reportedLatency = latency;
+        if (p._hostLatency) p._hostLatency->changed(p._host);
+      }
+      p._processor->setReportedLatency(latency);
+      p._processor->markAllParamsChanged();
+    }
+    return p._wrapped.activate(plugin, sampleRate, minFrames, maxFrames);
+  }
+
+  static const void* getExtension(const clap_plugin* plugin, const char* id) {
+    PluginExtensions& p = self(plugin);
+    if (p._processor) {
+      if (std::strcmp(id, CLAP_EXT_LATENCY) == 0) return &kLatency;
+      if (std::strcmp(id, CLAP_EXT_TAIL) == 0) return &kTail;
+      if (std::strcmp(id, CLAP_EXT_AUDIO_PORTS) == 0) return &kAudioPorts;
+      if (std::strcmp(id, CLAP_EXT_AUDIO_PORTS_CONFIG) == 0) return &kAudioPortsConfig;
+    }
+    if (p._wrappedParams && std::strcmp(id, CLAP_EXT_PARAMS) == 0) return &p._params;
+    if (p._wrappedState && std::strcmp(id, CLAP_EXT_STATE) == 0) return &p._state;
+    return p._wrapped.get_extension(plugin, id);
+  }
+
+  static void onMainThread(const clap_plugin* plugin) {
+    PluginExtensions& p = self(plugin);
+    if (p._wrapped.on_main_thread) p._wrapped.on_main_thread(plugin);
+    if (p._processor) p._processor->onMainThread();
+  }
+
+  // Audio thread
+  static void onHostRequest(void* context, typename Processor::HostRequest request) {
+    PluginExtensions& p = *static_cast<PluginExtensions*>(context);
+    switch (request) {
+      case Processor::HostRequest::kRestart:
+        p._host->request_restart(p._host);
+        break;
+      case Processor::HostRequest::kTailChanged:
+        if (p._hostTail) p._hostTail->changed(p._host);
+        break;
+      case Processor::HostRequest::kMainThreadCallback:
+        p._host->request_callback(p._host);
+        break;
+    }
+  }
+
+  static uint32_t latency(const clap_plugin* plugin) { return self(plugin)._reportedLatency; }
+
+  // Main or audio thread
+  static uint32_t tail(const clap_plugin* plugin) { return self(plugin)._processor->getCurrentTailSamples(); }
+
+  // Surround layouts have no CLAP port type without the surround extension, which
+  // would also have to describe the speaker positions, so they are left unspecified
+  static const char* portType(int channels) {
+    return channels == 1 ? CLAP_PORT_MONO : channels == 2 ? CLAP_PORT_STEREO : nullptr;
+  }
+
+  // Main thread
+  static uint32_t audioPortsCount(const clap_plugin*, bool) { return 1; }
+
+  static bool audioPortsGet(const clap_plugin* plugin, uint32_t index, bool isInput, clap_audio_port_info* info) {
+    if (index != 0) return false;
+    const int channels = self(plugin)._processor->getChannelCount();
+    info->id = 0;
+    std::snprintf(info->name, sizeof(info->name), "%s", isInput ? "Input" : "Output");
+    info->flags = CLAP_AUDIO_PORT_IS_MAIN;
+    info->channel_count = static_cast<uint32_t>(channels);
+    info->port_type = portType(channels);
+    // In-place processing is not offered
+    info->in_place_pair = CLAP_INVALID_ID;
+    return true;
+  }
+
+  // Main thread
+  static uint32_t configCount(const clap_plugin*) { return Processor::kNumChannelConfigs; }
+
+  static bool configGet(const clap_plugin*, uint32_t index, clap_audio_ports_config* config) {
+    if (index >= static_cast<uint32_t>(Processor::kNumChannelConfigs)) return false;
+    const auto& channelConfig = Processor::kChannelConfigs[index];
+    const uint32_t channels = static_cast<uint32_t>(channelConfig.channels);
+    config->id = index;
+    std::snprintf(config->name, sizeof(config->name), "%s", channelConfig.name);
+    config->input_port_count = 1;
+    config->output_port_count = 1;
+    config->has_main_input = true;
+    config->main_input_channel_count = channels;
+    config->main_input_port_type = portType(channelConfig.channels);
+    config->has_main_output = true;
+    config->main_output_channel_count = channels;
+    config->main_output_port_type = portType(channelConfig.channels);
+    return true;
+  }
+
+  // Main thread, only while deactivated; the layout applies from the next activation
+  static bool configSelect(const clap_plugin* plugin, clap_id id) {
+    if (id >= static_cast<clap_id>(Processor::kNumChannelConfigs)) return false;
+    self(plugin)._processor->setChannelCount(Processor::kChannelConfigs[id].channels);
+    return true;
+  }
+
+  static inline const clap_plugin_latency kLatency = { latency };
+  static inline const clap_plugin_tail kTail = { tail };
+  static inline const clap_plugin_audio_ports kAudioPorts = { audioPortsCount, audioPortsGet };
+  static inline const clap_plugin_audio_ports_config kAudioPortsConfig = { configCount, configGet, configSelect };
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Fixed-capacity wait-free SPSC queue. push() is called only from the producer
+// thread and pop() only from the consumer thread.
+template <typename T, size_t CAPACITY>
+class SpscRing {
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+public:
+  bool push(const T& item) {
+    const size_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) == CAPACITY) return false;
+    _items[head & (CAPACITY - 1)] = item;
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& item) {
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+    item = _items[tail & (CAPACITY - 1)];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::array<T, CAPACITY> _items{};
+  // Producer and consumer indices on separate cache lines
+  alignas(64) std::atomic<size_t> _head{ 0 };
+  alignas(64) std::atomic<size_t> _tail{ 0 };
+};
@@ -1,5 +1,6 @@
 #include "TanhSaturator-gui.h"
 #include "TanhSaturator.h"
+#include "dsp/SharedResource.h"
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -11,19 +12,84 @@
 
 // Constructor - plugin-specific implementation
 TanhSaturatorGUI::TanhSaturatorGUI(TanhSaturator* processor)
-  : CLAPAppView("TanhSaturator", processor) {
+  : CLAPAppView("TanhSaturator", processor), _saturator(processor) {
 
   // Set up grid system for fixed aspect ratio
   setGridSizeDefault(kDefaultGridSize);
   setGridSizeLimits(kMinGridSize, kMaxGridSize);
   setFixedAspectRatio({kGridUnitsX, kGridUnitsY});
+
+  // Collect audio-thread telemetry and analyzer audio only while the GUI is open
+  _saturator->getTelemetry().setEnabled(true);
+  _saturator->getAnalyzerTap().setEnabled(true);
+  _displayTimer.start([this]() { updateDisplays(); }, std::chrono::milliseconds(1000 / kDisplayRate));
+}
+
+TanhSaturatorGUI::~TanhSaturatorGUI() {
+  _displayTimer.stop();
+  _saturator->getTelemetry().setEnabled(false);
+  _saturator->getAnalyzerTap().setEnabled(false);
+}
+
+// Helper method - refreshes the live displays from the processor's lock-free channels
+void TanhSaturatorGUI::updateDisplays() {
+  if (!_view) return;
+  updateTelemetry();
+  updateAnalyzer();
+}
+
+// Helper method - drains every frame queued since the last update into the CPU meter.
+// When the processor is idle or asleep nothing arrives and the meter is left untouched,
+// so an idle editor skips its redraws entirely.
+void TanhSaturatorGUI::updateTelemetry() {
+  auto&& meterWidget = _view->_widgets["cpu_meter"];
+  auto* meter = meterWidget ? dynamic_cast<CpuMeterWidget*>(&*meterWidget) : nullptr;
+  if (!meter) return;
+
+  TelemetryFrame frame;
+  if (!_saturator->getTelemetry().pop(frame)) return;
+
+  meter->beginUpdate();
+  float loadSum = 0.f;
+  int frames = 0;
+  do {
+    meter->addFrame(frame);
+    loadSum += frame.load();
+    ++frames;
+  } while (_saturator->getTelemetry().pop(frame));
+
+  // Average load over this update; setting the property also marks the meter for redraw
+  meter->setFloatProperty("load", loadSum / frames);
+}
+
+// Helper method - drains analyzer audio and runs at most one FFT per display update.
+// Like the meter, the analyzer is left untouched when no new audio arrived, so it
+// neither runs the FFT nor marks itself for redraw.
+void TanhSaturatorGUI::updateAnalyzer() {
+  auto&& analyzerWidget = _view->_widgets["analyzer"];
+  auto* analyzer = analyzerWidget ? dynamic_cast<AnalyzerWidget*>(&*analyzerWidget) : nullptr;
+  if (!analyzer) return;
+
+  AnalyzerBlock block;
+  if (!_saturator->getAnalyzerTap().pop(block)) return;
+
+  do {
+    analyzer->addBlock(block);
+  } while (_saturator->getAnalyzerTap().pop(block));
+  analyzer->update();
 }
 
 // Pure virtual override from CLAPAppView
 void TanhSaturatorGUI::makeWidgets() {
+  TRACE_SCOPE("makeWidgets", this);
+
+  // Widgets that only change on resize (title, dial labels, separator) go in
+  // _backgroundWidgets. They are rendered once into the view's backing layer and
+  // redrawn only when layoutView() runs, not on every frame. Controls and live
+  // displays go in _widgets and are repainted only when marked dirty.
 
-  _view->_widgets.add_unique<TextLabelBasic>("title", ml::WithValues{
-    {"bounds", {0.02*kGridUnitsX, 0.0, 0.8*kGridUnitsX, 1.0}},
+  _view->_backgroundWidgets.add_unique<TextLabelBasic>("title", ml::WithValues{
+    {"bounds", {0.02*kGridUnitsX, 0.0, 0.6*kGridUnitsX, 1.0}},
     {"text", "TanhSaturator"},
     {"font", "d_din"},
     {"text_size", _drawingProperties.getFloatProperty("title_text_size")},
@@ -45,7 +111,7 @@ void TanhSaturatorGUI::makeWidgets() {
     {"param", "input"}
   });
 
-  _view->_widgets.add_unique<TextLabelBasic>("input_label", ml::WithValues{
+  _view->_backgroundWidgets.add_unique<TextLabelBasic>("input_label", ml::WithValues{
     {"text", "in"},
     {"font", "d_din"},
     {"text_size", _drawingProperties.getFloatProperty("label_text_size")},
@@ -68,7 +134,7 @@ void TanhSaturatorGUI::makeWidgets() {
     {"param", "output"}
   });
 
-  _view->_widgets.add_unique<TextLabelBasic>("output_label", ml::WithValues{
+  _view->_backgroundWidgets.add_unique<TextLabelBasic>("output_label", ml::WithValues{
     {"text", "out"},
     {"font", "d_din"},
     {"text_size", _drawingProperties.getFloatProperty("label_text_size")},
@@ -91,7 +157,7 @@ void TanhSaturatorGUI::makeWidgets() {
     {"param", "dry_wet"}
   });
 
-  _view->_widgets.add_unique<TextLabelBasic>("dry_wet_label", ml::WithValues{
+  _view->_backgroundWidgets.add_unique<TextLabelBasic>("dry_wet_label", ml::WithValues{
     {"text", "mix"},
     {"font", "d_din"},
     {"text_size", _drawingProperties.getFloatProperty("label_text_size")},
@@ -114,7 +180,7 @@ void TanhSaturatorGUI::makeWidgets() {
     {"param", "lowpass"}
   });
 
-  _view->_widgets.add_unique<TextLabelBasic>("lowpass_label", ml::WithValues{
+  _view->_backgroundWidgets.add_unique<TextLabelBasic>("lowpass_label", ml::WithValues{
     {"text", "lpf"},
     {"font", "d_din"},
     {"text_size", _drawingProperties.getFloatProperty("label_text_size")},
@@ -137,7 +203,7 @@ void TanhSaturatorGUI::makeWidgets() {
     {"param", "lowpass_q"}
   });
 
-  _view->_widgets.add_unique<TextLabelBasic>("lowpass_q_label", ml::WithValues{
+  _view->_backgroundWidgets.add_unique<TextLabelBasic>("lowpass_q_label", ml::WithValues{
     {"text", "q"},
     {"font", "d_din"},
     {"text_size", _drawingProperties.getFloatProperty("label_text_size")},
@@ -148,13 +214,27 @@ void TanhSaturatorGUI::makeWidgets() {
   });
 
   // horizontal separator line
-  _view->_widgets.add_unique<LineWidget>("separator_line", ml::WithValues{
+  _view->_backgroundWidgets.add_unique<LineWidget>("separator_line", ml::WithValues{
     {"bounds", {0.1, 0.4, 8.8, 1.0}},  // x, y, width, height
     {"color", _drawingProperties.getMatrixProperty("text_color")},  // gray color
     {"thickness", 4.0f},  // 2 pixel thick line
     {"opacity", 0.8f}     // 80% opacity
   });
 
+  // Transfer curve and output spectrum, fed by updateAnalyzer()
+  _view->_widgets.add_unique<AnalyzerWidget>("analyzer", ml::WithValues{
+    {"bounds", {0.3, 3.3, 8.4, 1.5}},
+    {"color", _drawingProperties.getMatrixProperty("text_color")},
+    {"opacity", 0.9f}
+  });
+
+  // Audio-thread load meter, fed by updateTelemetry()
+  _view->_widgets.add_unique<CpuMeterWidget>("cpu_meter", ml::WithValues{
+    {"bounds", {5.6, 0.1, 3.2, 0.6}},
+    {"color", _drawingProperties.getMatrixProperty("text_color")},
+    {"opacity", 0.8f}
+  });
+
   // Add resize widget to bottom right corner
   _view->_backgroundWidgets.add_unique<Resizer>("resizer", ml::WithValues{
     {"fix_ratio", static_cast<float>(kGridUnitsX)/static_cast<float>(kGridUnitsY)},  // Use grid constants for aspect ratio
@@ -167,10 +247,11 @@ void TanhSaturatorGUI::makeWidgets() {
 
 // Override from AppView - called when GUI needs to update widget positions  
 void TanhSaturatorGUI::layoutView(ml::DrawContext dc) {
+  TRACE_SCOPE("layoutView", this);
 
   // Helper lambda - plugin-specific utility for positioning dial labels
   auto positionLabelUnderDial = [&](ml::Path dialName, ml::Path labelName) {
-    if (!_view->_widgets[dialName] || !_view->_widgets[labelName]) {
+    if (!_view->_widgets[dialName] || !_view->_backgroundWidgets[labelName]) {
       return; // Widgets not created yet or we can't find them
     }
     
@@ -181,10 +262,10 @@ void TanhSaturatorGUI::layoutView(ml::DrawContext dc) {
     float labelY = dialRect.top() + yGap;
     
     // Get current label bounds and update position with dial's width
-    ml::Rect currentBounds = _view->_widgets[labelName]->getRectProperty("bounds");
+    ml::Rect currentBounds = _view->_backgroundWidgets[labelName]->getRectProperty("bounds");
     ml::Rect newBounds(dialRect.left(), labelY, dialRect.width(), currentBounds.height());
     
-    _view->_widgets[labelName]->setRectProperty("bounds", newBounds);
+    _view->_backgroundWidgets[labelName]->setRectProperty("bounds", newBounds);
   };
 
   // Position TanhSaturator dials
@@ -196,48 +277,61 @@ void TanhSaturatorGUI::layoutView(ml::DrawContext dc) {
 
 }
 
-// Pure virtual override from CLAPAppView - must implement to set up fonts, colors, and layout
-void TanhSaturatorGUI::initializeResources(NativeDrawContext* nvg) {
-  if (!nvg) return;
+// The visual style depends only on constants, so it is built once and shared by
+// every open editor in the process, which copy it into their own properties.
+namespace {
+ml::PropertyTree* buildDrawingProperties() {
+  auto* properties = new ml::PropertyTree;
 
   // Set up visual style for this plugin
-  _drawingProperties.setProperty("mark", ml::colorToMatrix({ 0.1, 0.1, 0.1, 1.0 }));
-  _drawingProperties.setProperty("mark_bright", ml::colorToMatrix({ 0.1, 0.1, 0.1, 1.0 }));
-  _drawingProperties.setProperty("background", ml::colorToMatrix(nvgHSL(29.0 / 360, 0.5f, 0.9f)));
-  _drawingProperties.setProperty("text_color", ml::colorToMatrix({ 0.1, 0.1, 0.1, 1.0 }));
-  _drawingProperties.setProperty("line_color", ml::colorToMatrix({ 0.1, 0.1, 0.1, 1.0 }));
-  _drawingProperties.setProperty("common_stroke_width", 1 / 32.f);
+  properties->setProperty("mark", ml::colorToMatrix({ 0.1, 0.1, 0.1, 1.0 }));
+  properties->setProperty("mark_bright", ml::colorToMatrix({ 0.1, 0.1, 0.1, 1.0 }));
+  properties->setProperty("background", ml::colorToMatrix(nvgHSL(29.0 / 360, 0.5f, 0.9f)));
+  properties->setProperty("text_color", ml::colorToMatrix({ 0.1, 0.1, 0.1, 1.0 }));
+  properties->setProperty("line_color", ml::colorToMatrix({ 0.1, 0.1, 0.1, 1.0 }));
+  properties->setProperty("common_stroke_width", 1 / 32.f);
 
   // Centralized typography
-  _drawingProperties.setProperty("title_text_size", 0.5f);
-  _drawingProperties.setProperty("label_text_size", 0.3f);
-  _drawingProperties.setProperty("dial_text_size", 0.5f);
+  properties->setProperty("title_text_size", 0.5f);
+  properties->setProperty("label_text_size", 0.3f);
+  properties->setProperty("dial_text_size", 0.5f);
 
   // Dial properties
-  _drawingProperties.setProperty("dial_size", 0.7f);      // Visual size of the dial knob
-  _drawingProperties.setProperty("dial_bounds", 1.6f);   // Bounds size for positioning
+  properties->setProperty("dial_size", 0.7f);      // Visual size of the dial knob
+  properties->setProperty("dial_bounds", 1.6f);   // Bounds size for positioning
 
   // Single row for all dials
-  _drawingProperties.setProperty("dial_row_y", 1.4f);
+  properties->setProperty("dial_row_y", 1.4f);
 
   // Column positions for five dials in one row
-  float dialBounds = _drawingProperties.getFloatProperty("dial_bounds");
+  float dialBounds = properties->getFloatProperty("dial_bounds");
   float totalWidth = kGridUnitsX;
   float spacing = (totalWidth - 5 * dialBounds) / 6.0f; // Equal spacing between dials and edges
   
-  _drawingProperties.setProperty("input_dial_x", spacing * 1 + dialBounds * 0);
-  _drawingProperties.setProperty("output_dial_x", spacing * 2 + dialBounds * 1);
-  _drawingProperties.setProperty("lowpass_dial_x", spacing * 3 + dialBounds * 2);
-  _drawingProperties.setProperty("lowpass_q_dial_x", spacing * 4 + dialBounds * 3);
-  _drawingProperties.setProperty("dry_wet_dial_x", spacing * 5 + dialBounds * 4);
+  properties->setProperty("input_dial_x", spacing * 1 + dialBounds * 0);
+  properties->setProperty("output_dial_x", spacing * 2 + dialBounds * 1);
+  properties->setProperty("lowpass_dial_x", spacing * 3 + dialBounds * 2);
+  properties->setProperty("lowpass_q_dial_x", spacing * 4 + dialBounds * 3);
+  properties->setProperty("dry_wet_dial_x", spacing * 5 + dialBounds * 4);
+
+  // Helpful for debugging layout
+  // Uncomment these and `make -j` in your build directory to enable them
+  // properties->setProperty("draw_widget_bounds", true);
+  // properties->setProperty("draw_background_grid", true);
+  return properties;
+}
+} // namespace
+
+// Pure virtual override from CLAPAppView - must implement to set up fonts, colors, and layout
+void TanhSaturatorGUI::initializeResources(NativeDrawContext* nvg) {
+  TRACE_SCOPE("initializeResources", this);
+  if (!nvg) return;
+
+  _sharedDrawingProperties = dsp::SharedResource<ml::PropertyTree>::acquire(0, buildDrawingProperties);
+  _drawingProperties = *_sharedDrawingProperties;
 
   // Load embedded fonts (essential for text to work properly)
   // These fonts are embedded as C arrays and loaded directly from memory
   _resources.fonts["d_din"] = std::make_unique<ml::FontResource>(nvg, "d_din", resources::D_DIN_otf, resources::D_DIN_otf_size, 0);
   _resources.fonts["d_din_italic"] = std::make_unique<ml::FontResource>(nvg, "d_din_italic", resources::D_DIN_Italic_otf, resources::D_DIN_Italic_otf_size, 0);
-
-  // Helpful for debugging layout
-  // Uncomment these and `make -j` in your build directory to enable them
-  // _drawingProperties.setProperty("draw_widget_bounds", true);
-  // _drawingProperties.setProperty("draw_background_grid", true);
 }
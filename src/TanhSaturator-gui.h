@@ -2,11 +2,15 @@
 
 #include "CLAPExport.h"
 #include "nanovg.h"
+#include "MLTimer.h"
+#include "widgets/AnalyzerWidget.h"
+#include "widgets/CpuMeterWidget.h"
 #include "widgets/LineWidget.h"
+#include <memory>
 #include <string>
 
 constexpr int kGridUnitsX{ 9 };
-constexpr int kGridUnitsY{ 3 };
+constexpr int kGridUnitsY{ 5 };
 constexpr int kDefaultGridSize{ 60 };
 constexpr int kMinGridSize{ 30 };
 constexpr int kMaxGridSize{ 120 };
@@ -19,7 +23,7 @@ class TanhSaturatorGUI : public ml::CLAPAppView<TanhSaturator> {
   public:
     // Constructor
     TanhSaturatorGUI(TanhSaturator* processor);
-    ~TanhSaturatorGUI() override = default;
+    ~TanhSaturatorGUI() override;
 
     // Create your specific widgets
     void makeWidgets() override;
@@ -29,4 +33,18 @@ class TanhSaturatorGUI : public ml::CLAPAppView<TanhSaturator> {
 
     // Set up your visual style
     void initializeResources(NativeDrawContext* nvg) override;
+
+  private:
+    // Called by the display timer, which caps meter and analyzer updates at kDisplayRate
+    void updateDisplays();
+    void updateTelemetry();
+    void updateAnalyzer();
+
+    static constexpr int kDisplayRate{ 30 };
+
+    TanhSaturator* _saturator;
+    ml::Timer _displayTimer;
+
+    // Keeps the shared visual style alive while this editor is open
+    std::shared_ptr<const ml::PropertyTree> _sharedDrawingProperties;
 };
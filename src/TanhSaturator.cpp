@@ -1,10 +1,65 @@
 #include "TanhSaturator.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <type_traits>
+
+// Names of the parameters read by the process path, in ParamIndex order
+const char* const TanhSaturator::kParamNames[kNumParams] = {
+  "input",
+  "output",
+  "dry_wet",
+  "lowpass",
+  "lowpass_q",
+  "quality",
+  "oversampling",
+  "oversampling_mode",
+  "adaa",
+  "bands",
+  "crossover_low",
+  "crossover_mid",
+  "crossover_high",
+  "band1_drive",
+  "band2_drive",
+  "band3_drive",
+  "band4_drive",
+  "band1_output",
+  "band2_output",
+  "band3_output",
+  "band4_output",
+  "stereo_mode",
+  "lowpass_mode"
+};
+
+const TanhSaturator::ChannelConfig TanhSaturator::kChannelConfigs[kNumChannelConfigs] = {
+  { "Stereo", 2 },
+  { "5.1", 6 },
+  { "7.1", 8 },
+  { "7.1.4", 12 },
+  { "9.1.6", 16 }
+};
+
+namespace {
+
+// Settings decoded from parameter values
+int oversamplingFactorLog2FromParam(float value) { return static_cast<int>(value + 0.5f); }
+
+dsp::OversamplingMode oversamplingModeFromParam(float value) {
+  return value > 0.5f ? dsp::OversamplingMode::kMinimumPhase : dsp::OversamplingMode::kLinearPhase;
+}
+
+dsp::AdaaOrder adaaOrderFromParam(float value) {
+  return static_cast<dsp::AdaaOrder>(std::max(0, std::min(2, static_cast<int>(value + 0.5f))));
+}
+
+} // namespace
 
 // Constructor - plugin-specific implementation
 TanhSaturator::TanhSaturator() {
+  TRACE_SCOPE("TanhSaturator", this);
+
   // buildParameterDescriptions() sets up the plugin's parameter system:
   // - Defines parameter names, ranges, default values, and units
   // - Creates the parameter tree that hosts can query and automate
@@ -12,6 +67,12 @@ TanhSaturator::TanhSaturator() {
   // This is called in the constructor because parameters must be defined
   // before the plugin can be used by hosts.
   buildParameterDescriptions();
+
+  // Parameter names are resolved to paths once per process, so neither construction
+  // nor the process path builds a Path from a string.
+  // NaN never compares equal, so every parameter reads as changed on the first block.
+  paramCache.paths = dsp::SharedResource<ParamPaths>::acquire(0, makeParamPaths);
+  paramCache.values.fill(std::numeric_limits<float>::quiet_NaN());
   
   // For simple stateless effects like tanh saturation, no additional
   // initialization is needed here. More complex effects might:
@@ -32,118 +93,695 @@ void TanhSaturator::setSampleRate(double sr) {
   // - Configure time-based parameters (LFO rates, envelope times)
   // - Recalculate any sample-rate dependent constants
   
-  // Initialize lowpass filters following CLAP saw demo pattern
-  // Use the parameter system's default value (defined in buildParameterDescriptions)
-  float defaultFreq = this->getRealFloatParam("lowpass");
-  float defaultQ = this->getRealFloatParam("lowpass_q");
-  
-  // Lopass::makeCoeffs expects k = 1/Q, where k=0 is maximum resonance
-  float filterK = 1.0f / defaultQ;
-  effectState.lowpassL._coeffs = ml::Lopass::makeCoeffs(defaultFreq / sr, filterK);
-  effectState.lowpassR._coeffs = ml::Lopass::makeCoeffs(defaultFreq / sr, filterK);
+  // Cache the sample rate; filter coefficients are recomputed on the next processVector()
+  effectState.sampleRate = static_cast<float>(sr);
+  effectState.inverseSampleRate = 1.0f / effectState.sampleRate;
+  paramCache.markDirty(kLowpassParam);
+  paramCache.markDirty(kCrossoverLowParam);
+
+  // Acquire the coefficient table for the new rate. The filters are reset first so
+  // they no longer refer to the previous table, which may be released here.
+  forEachPack([](auto& pack) { pack.lowpass.reset(); });
+  effectState.lowpassTable = dsp::SvfCoeffTable::acquire(effectState.sampleRate);
+}
+
+void TanhSaturator::setChannelCount(int channels) {
+  channels = std::max(1, std::min(channels, kMaxChannels));
+  const size_t remainder = static_cast<size_t>(channels) % kWidePackLanes;
+  const size_t nWidePacks = static_cast<size_t>(channels) / kWidePackLanes + (remainder > 2 ? 1 : 0);
+  effectState.widePacks.resize(nWidePacks);
+  effectState.stereoPackUsed = (remainder == 1 || remainder == 2);
+  for (auto& pack : effectState.widePacks) {
+    if (!pack) pack = std::make_unique<ChannelPack<kWidePackLanes>>();
+  }
+  effectState.channelCount = channels;
+  effectState.bandStatesReady = false;
+  if (effectState.bands > 1) allocateBandStates();
+
+  // New packs pick up the current settings on the next processVector(), and every
+  // pack starts from silence so all channels stay aligned
+  paramCache.dirty = ~0u;
+  forEachPack([](auto& pack) {
+    pack.lowpass.reset();
+    pack.clearState();
+  });
+}
+
+void TanhSaturator::allocateBandStates() {
+  forEachPack([](auto& pack) {
+    if (pack.bandStorage) return;
+    pack.bandStorage = std::make_unique<typename std::decay_t<decltype(pack)>::BandStates>();
+    pack.bandStates.store(pack.bandStorage.get(), std::memory_order_release);
+  });
+}
+
+// Helper method - starts using the band states allocated since the last call, with
+// the current oversampling and ADAA settings. Until every pack has its states, asks
+// the host for a main-thread callback to allocate them, once.
+void TanhSaturator::takeUpBandStates(int factorLog2, dsp::OversamplingMode mode, dsp::AdaaOrder order) {
+  if (!hostRequestCallback) allocateBandStates();
+
+  bool ready = true;
+  forEachPack([&](auto& pack) {
+    if (pack.bandStatesConfigured) return;
+    if (!pack.bandStates.load(std::memory_order_acquire)) {
+      ready = false;
+      return;
+    }
+    pack.bandStatesConfigured = true;
+    pack.forEachBandSaturation([&](auto& bands) {
+      bands.oversampler.setFactor(factorLog2);
+      bands.oversampler.setMode(mode);
+      bands.adaa.setOrder(order);
+    });
+  });
+
+  effectState.bandStatesReady = ready;
+  if (ready) {
+    mainThreadCallbackRequested = false;
+  } else if (!mainThreadCallbackRequested) {
+    mainThreadCallbackRequested = true;
+    hostRequestCallback(hostRequestContext, HostRequest::kMainThreadCallback);
+  }
 }
 
 // Unified interface - called by SignalProcessBuffer for each DSP vector
 void TanhSaturator::processVector(const ml::DSPVectorDynamic& inputs, ml::DSPVectorDynamic& outputs, void* stateData) {
   // Get AudioContext from stateData for sample rate access
   auto* audioContext = static_cast<ml::AudioContext*>(stateData);
-  // Get input channels (inputs is const, so we copy to create outputs)
-  ml::DSPVector leftInput = inputs[0];
-  ml::DSPVector rightInput = inputs[1];
-  
-  // Create output buffers
-  ml::DSPVector leftOutput = leftInput;
-  ml::DSPVector rightOutput = rightInput;
+  TRACE_SCOPE("processVector", this);
+  telemetry.beginBlock();
 
-  // Update effect state (including cached sample rate)
-  updateEffectState(audioContext->getSampleRate());
-  
-  // Process the stereo effect
-  processStereoEffect(leftOutput, rightOutput);
-  
-  // Set outputs
-  outputs[0] = leftOutput;
-  outputs[1] = rightOutput;
-}
-
-// Helper method - plugin-specific DSP processing
-void TanhSaturator::processStereoEffect(ml::DSPVector& leftChannel, ml::DSPVector& rightChannel) {
-  // Get effect parameters
-  float inputGain = this->getRealFloatParam("input");
-  float outputGain = this->getRealFloatParam("output");
-  float lowpassFreq = this->getRealFloatParam("lowpass");
-  float lowpassQ = this->getRealFloatParam("lowpass_q");
-  float dryWetMix = this->getRealFloatParam("dry_wet");
-
-  // Store original input for dry signal
-  ml::DSPVector inputLeft = leftChannel;
-  ml::DSPVector inputRight = rightChannel;
-  
-  // Step 1: Apply tanh saturation to both channels
-  leftChannel = processTanhSaturation(leftChannel, inputGain, outputGain);
-  rightChannel = processTanhSaturation(rightChannel, inputGain, outputGain);
-  
-  // Step 2: Apply post-saturation lowpass filtering using Lopass filters
-  // Use pre-computed inverse sample rate for fast frequency normalization (multiplication vs division)
-  float normalizedFreq = lowpassFreq * effectState.inverseSampleRate;
-  normalizedFreq = std::min(normalizedFreq, 0.45f);  // clamp below nyquist; we might not need this
+  // Read parameters and update derived state only where something changed
+  readParams();
+  updateEffectState(audioContext ? audioContext->getSampleRate() : effectState.sampleRate);
   
-  // Lopass::makeCoeffs expects k = 1/Q, where k=0 is maximum resonance
-  float filterK = 1.0f / lowpassQ;
-  effectState.lowpassL._coeffs = ml::Lopass::makeCoeffs(normalizedFreq, filterK);
-  effectState.lowpassR._coeffs = ml::Lopass::makeCoeffs(normalizedFreq, filterK);
-  
-  // Step 3: lowpass filter the saturated signals
-  leftChannel = effectState.lowpassL(leftChannel);
-  rightChannel = effectState.lowpassR(rightChannel);
-  
-  // Step 4: Apply dry/wet mix
-  ml::DSPVector wetNorm = ml::DSPVector(dryWetMix);
-  ml::DSPVector dryMix = ml::DSPVector(1.0f) - wetNorm * wetNorm;
-  ml::DSPVector wetMix = ml::DSPVector(1.0f) - dryMix;
-  
-  // Mix dry and wet signals
-  leftChannel = inputLeft * dryMix + leftChannel * wetMix;
-  rightChannel = inputRight * dryMix + rightChannel * wetMix;
+  // Process every channel with the kernel specialized for the active stages,
+  // reading the inputs and writing the outputs directly
+  (this->*selectProcessKernel())(inputs, outputs);
+  paramCache.dirty = 0;
+
+  // Output buffers past the processed channels are silent
+  const size_t channels = bufferChannels(inputs, outputs);
+  for (size_t c = channels; c < outputs.size(); ++c) outputs[c] = ml::DSPVector(0.0f);
+
+  // Decide from the signal whether the host may put the plugin to sleep
+  updateActivity(inputs, channels);
+  if (channels == 0) return;
+
+  // The meter and analyzer follow the front left and right channels
+  const size_t right = std::min<size_t>(1, channels - 1);
+  telemetry.endBlock(outputs[0], outputs[right], effectState.sampleRate);
+  writeAnalyzer(inputs[0], inputs[right], outputs[0], outputs[right]);
+}
+
+// Helper method - hands the output and current settings to the GUI analyzer while it is open
+void TanhSaturator::writeAnalyzer(const ml::DSPVector& leftInput, const ml::DSPVector& rightInput,
+                                  const ml::DSPVector& leftOutput, const ml::DSPVector& rightOutput) {
+  if (!analyzer.isEnabled()) {
+    analyzer.skip();
+    return;
+  }
+
+  AnalyzerSettings settings;
+  settings.inputGain = paramCache[kInputParam];
+  settings.outputGain = paramCache[kOutputParam];
+  settings.lowpassHz = paramCache[kLowpassParam];
+  settings.lowpassQ = paramCache[kLowpassQParam];
+  settings.filterActive = effectState.filterActive;
+  settings.quality = static_cast<int>(effectState.tanhQuality);
+  analyzer.write(leftInput, rightInput, leftOutput, rightOutput, effectState.sampleRate, settings);
+}
+
+bool TanhSaturator::isParamName(const char* name) { return paramIndex(name) >= 0; }
+
+int TanhSaturator::paramIndex(const char* name) {
+  for (int i = 0; i < kNumParams; ++i) {
+    if (std::strcmp(name, kParamNames[i]) == 0) return i;
+  }
+  return -1;
+}
+
+void TanhSaturator::resetProcessingState() {
+  // Bring derived state up to date with the current parameters first
+  markAllParamsChanged();
+  readParams();
+  updateEffectState(effectState.sampleRate);
+  paramCache.dirty = 0;
+
+  effectState.inputGain.reset(effectState.inputGain.getTarget());
+  effectState.outputGain.reset(effectState.outputGain.getTarget());
+  effectState.dryGain.reset(effectState.dryGain.getTarget());
+  effectState.wetGain.reset(effectState.wetGain.getTarget());
+  for (int b = 0; b < dsp::kMaxBands; ++b) {
+    effectState.bandDrive[b].reset(effectState.bandDrive[b].getTarget());
+    effectState.bandOutput[b].reset(effectState.bandOutput[b].getTarget());
+  }
+  forEachPack([](auto& pack) {
+    pack.lowpass.jumpToTarget();
+    pack.clearState();
+  });
+  effectState.filterActive = paramCache[kLowpassParam] < kLowpassMaxFrequency * 0.999f;
+  effectState.silentSamples = 0;
+}
+
+// Helper method - plugin-specific DSP processing, specialized on the active stages
+template <bool MIX, bool FILTER, bool OUTPUT_GAIN, int FACTOR_LOG2>
+void TanhSaturator::processEffect(const ml::DSPVectorDynamic& inputs, ml::DSPVectorDynamic& outputs) {
+  // Smoothed gains for this vector. Constant vectors when nothing is ramping.
+  VectorGains gains;
+  gains.input = effectState.inputGain.next();
+  if constexpr (MIX) {
+    gains.dry = effectState.dryGain.next();
+    gains.wet = effectState.wetGain.next();
+    if constexpr (OUTPUT_GAIN) {
+      gains.wet *= effectState.outputGain.next();
+    }
+  } else if constexpr (OUTPUT_GAIN) {
+    gains.wet = effectState.outputGain.next();
+  }
+  for (int b = 0; b < effectState.bands; ++b) {
+    gains.bandDrive[b] = effectState.bandDrive[b].next();
+    gains.bandOutput[b] = effectState.bandOutput[b].next();
+  }
+
+  // Wide packs first, then the remaining one or two channels on the stereo pack.
+  // Packs left without buffers hold their state.
+  const size_t channels = bufferChannels(inputs, outputs);
+  size_t first = 0;
+  for (auto& pack : effectState.widePacks) {
+    if (first == channels) return;
+    const size_t count = std::min(kWidePackLanes, channels - first);
+    processPack<MIX, FILTER, OUTPUT_GAIN, FACTOR_LOG2>(*pack, inputs, outputs, first, count, gains);
+    first += count;
+  }
+  if (effectState.stereoPackUsed && first < channels) {
+    processPack<MIX, FILTER, OUTPUT_GAIN, FACTOR_LOG2>(effectState.stereoPack, inputs, outputs, first,
+                                                       channels - first, gains);
+  }
+}
+
+template <bool MIX, bool FILTER, bool OUTPUT_GAIN, int FACTOR_LOG2, size_t LANES>
+void TanhSaturator::processPack(ChannelPack<LANES>& pack, const ml::DSPVectorDynamic& inputs,
+                                ml::DSPVectorDynamic& outputs, size_t first, size_t count, const VectorGains& gains) {
+  // Mid/side modes apply to the stereo layout, whose two channels are this pack.
+  // In kMidOnly and kSideOnly one lane bypasses the saturator and the lowpass.
+  const StereoMode stereoMode = (LANES == 2 && effectState.channelCount == 2 && count == 2) ? effectState.stereoMode
+                                                                                           : StereoMode::kLeftRight;
+  const bool midSide = stereoMode != StereoMode::kLeftRight;
+  const uint32_t bypassLanes = (stereoMode == StereoMode::kMidOnly) ? 2u : (stereoMode == StereoMode::kSideOnly) ? 1u : 0u;
+
+  // Pack the channels with input gain applied, encoding to mid and side on the
+  // way. This is the only copy of the signal; the inputs stay untouched and
+  // serve as the dry signal. A bypassed lane gets no input gain.
+  ml::DSPVectorArray<LANES> wet;
+  if (midSide) {
+    const ml::DSPVector half(0.5f);
+    const ml::DSPVector drive = gains.input * half;
+    wet.row(0) = (inputs[first] + inputs[first + 1]) * ((bypassLanes & 1u) ? half : drive);
+    wet.row(1) = (inputs[first] - inputs[first + 1]) * ((bypassLanes & 2u) ? half : drive);
+  } else {
+    for (size_t c = 0; c < LANES; ++c) {
+      wet.row(static_cast<int>(c)) = (c < count) ? inputs[first + c] * gains.input : ml::DSPVector(0.0f);
+    }
+  }
+
+  // Step 1: Apply tanh saturation to every lane, oversampled if enabled,
+  // either broadband or to each crossover band
+  {
+    TRACE_SCOPE("saturation", this);
+    if (effectState.bands > 1 && effectState.bandStatesReady) {
+      processMultibandSaturation<FACTOR_LOG2>(pack, wet, gains, bypassLanes);
+    } else {
+      processTanhSaturation<FACTOR_LOG2>(pack, wet, bypassLanes);
+    }
+  }
+  telemetry.endStage(kSaturationStage);
+
+  // Step 2: Apply post-saturation lowpass filtering.
+  // Coefficient targets are set by updateEffectState(); the filter ramps toward them per sample.
+  if constexpr (FILTER) {
+    TRACE_SCOPE("lowpass", this);
+    if (bypassLanes) {
+      const ml::DSPVectorArray<LANES> unfiltered = wet;
+      pack.lowpass.process(wet);
+      for (size_t c = 0; c < LANES; ++c) {
+        if ((bypassLanes >> c) & 1u) wet.row(static_cast<int>(c)) = unfiltered.constRow(static_cast<int>(c));
+      }
+    } else {
+      pack.lowpass.process(wet);
+    }
+    telemetry.endStage(kFilterStage);
+  }
+
+  // Step 3: Decode mid and side back to left and right, then apply dry/wet mix
+  // with output gain folded into the wet gain, writing straight into the outputs
+  TRACE_SCOPE("mix", this);
+  if (midSide) {
+    const ml::DSPVector mid = wet.constRow(0);
+    const ml::DSPVector side = wet.constRow(1);
+    wet.row(0) = mid + side;
+    wet.row(1) = mid - side;
+  }
+  // The dry signal is delayed by the wet path's latency. Without the mix its
+  // history is still kept, so the mix comes back in without a glitch.
+  for (size_t c = 0; c < count; ++c) {
+    if constexpr (MIX) {
+      const ml::DSPVector dry = pack.dryDelay.process(c, inputs[first + c]);
+      outputs[first + c] = dry * gains.dry + wet.constRow(static_cast<int>(c)) * gains.wet;
+    } else {
+      pack.dryDelay.write(c, inputs[first + c]);
+      if constexpr (OUTPUT_GAIN) {
+        outputs[first + c] = wet.constRow(static_cast<int>(c)) * gains.wet;
+      } else {
+        outputs[first + c] = wet.constRow(static_cast<int>(c));
+      }
+    }
+  }
+  telemetry.endStage(kMixStage);
 }
 
 // Helper method - plugin-specific tanh saturation algorithm
-ml::DSPVector TanhSaturator::processTanhSaturation(const ml::DSPVector& inputSamples, float inputGain, float outputGain) {
-  // Apply input gain
-  ml::DSPVector processed = inputSamples * inputGain;
-  
-  // Apply tanh saturation
-  // tanh(x) = (exp(x) - exp(-x)) / (exp(x) + exp(-x))
-  // madronalib provides a SIMD-optimized exp() function
-  ml::DSPVector expPos = exp(processed);
-  ml::DSPVector expNeg = exp(ml::DSPVector(0.0f) - processed); // madronalib doesn't currently have a unary minus operator for DSPVectors, so we need to subtract from a DSPVector's worth of 0.0f
-  processed = (expPos - expNeg) / (expPos + expNeg);
-  
-  // Apply output gain
-  processed *= outputGain;
-  
-  return processed;
+template <int FACTOR_LOG2, size_t LANES>
+void TanhSaturator::processTanhSaturation(ChannelPack<LANES>& pack, ml::DSPVectorArray<LANES>& samples,
+                                          uint32_t bypassLanes) {
+  saturate<FACTOR_LOG2>(pack.oversampler, pack.adaa, samples, bypassLanes);
+}
+
+// Helper method - multiband variant of processTanhSaturation()
+template <int FACTOR_LOG2, size_t LANES>
+void TanhSaturator::processMultibandSaturation(ChannelPack<LANES>& pack, ml::DSPVectorArray<LANES>& samples,
+                                               const VectorGains& gains, uint32_t bypassLanes) {
+  auto& states = *pack.activeBandStates();
+  if (effectState.bands == 2) {
+    processBands<2, FACTOR_LOG2>(pack, states.twoBands, samples, gains, bypassLanes);
+  } else {
+    processBands<dsp::kMaxBands, FACTOR_LOG2>(pack, states.fourBands, samples, gains, bypassLanes);
+  }
+}
+
+template <int BANDS, int FACTOR_LOG2, size_t LANES>
+void TanhSaturator::processBands(ChannelPack<LANES>& pack, BandSaturation<LANES * BANDS>& state,
+                                 ml::DSPVectorArray<LANES>& samples, const VectorGains& gains, uint32_t bypassLanes) {
+  using Crossover = dsp::Crossover<LANES>;
+  const int nBands = effectState.bands;
+
+  // Split into bands and apply each band's drive. Every band of every channel is
+  // a lane of one pack, so the saturator runs once for all of them. Bypassed
+  // channels are still split, so they pick up the same allpass phase as the rest.
+  ml::DSPVectorArray<LANES * BANDS> bands;
+  uint32_t bypassBands = 0;
+  pack.crossover.template process<BANDS>(samples, bands);
+  for (size_t c = 0; c < LANES; ++c) {
+    const bool bypass = (bypassLanes >> c) & 1u;
+    for (int b = 0; b < nBands; ++b) {
+      if (bypass) {
+        bypassBands |= 1u << Crossover::row(b, c);
+      } else {
+        bands.row(Crossover::row(b, c)) *= gains.bandDrive[b];
+      }
+    }
+  }
+
+  saturate<FACTOR_LOG2>(state.oversampler, state.adaa, bands, bypassBands);
+
+  // Sum the bands back to one signal per channel with each band's output gain.
+  // A bypassed channel is summed at unity.
+  for (size_t c = 0; c < LANES; ++c) {
+    const bool bypass = (bypassLanes >> c) & 1u;
+    ml::DSPVector sum(0.0f);
+    for (int b = 0; b < nBands; ++b) {
+      const ml::DSPVector& band = bands.constRow(Crossover::row(b, c));
+      sum += bypass ? band : band * gains.bandOutput[b];
+    }
+    samples.row(static_cast<int>(c)) = sum;
+  }
+}
+
+template <int FACTOR_LOG2, size_t N>
+void TanhSaturator::saturate(dsp::Oversampler<N>& oversampler, dsp::TanhAdaa<N>& adaa, ml::DSPVectorArray<N>& samples,
+                             uint32_t bypassLanes) {
+  // Apply tanh saturation using the kernel tier chosen by the "quality" parameter,
+  // with antiderivative anti-aliasing if enabled. See dsp/FastTanh.h and dsp/TanhAdaa.h.
+  // Gains are linear, so they are applied at the host rate even when oversampling.
+  // Bypassed lanes are put back after the saturator. They do not get the ADAA delay
+  // of half a sample (first order) or one sample (second order).
+  auto saturatePack = [&](ml::DSPVectorArray<N>& pack) {
+    if (bypassLanes == 0) {
+      pack = adaa.process(pack, effectState.tanhQuality);
+      return;
+    }
+    const ml::DSPVectorArray<N> clean = pack;
+    pack = adaa.process(pack, effectState.tanhQuality);
+    for (size_t c = 0; c < N; ++c) {
+      if ((bypassLanes >> c) & 1u) pack.row(static_cast<int>(c)) = clean.constRow(static_cast<int>(c));
+    }
+  };
+
+  if constexpr (FACTOR_LOG2 == 0) {
+    saturatePack(samples);
+  } else {
+    // Saturate each high-rate pack, then filter back down to the host rate
+    oversampler.upsample(samples);
+    for (int i = 0; i < (1 << FACTOR_LOG2); ++i) {
+      saturatePack(oversampler.pack(i));
+    }
+    oversampler.downsample(samples);
+  }
+}
+
+// Kernels for every oversampling factor, for one combination of stage flags
+template <bool MIX, bool FILTER, bool OUTPUT_GAIN>
+constexpr TanhSaturator::KernelsByFactor TanhSaturator::kernelsFor() {
+  return {
+    &TanhSaturator::processEffect<MIX, FILTER, OUTPUT_GAIN, 0>,
+    &TanhSaturator::processEffect<MIX, FILTER, OUTPUT_GAIN, 1>,
+    &TanhSaturator::processEffect<MIX, FILTER, OUTPUT_GAIN, 2>,
+    &TanhSaturator::processEffect<MIX, FILTER, OUTPUT_GAIN, 3>
+  };
+}
+
+// Indexed by [MIX << 2 | FILTER << 1 | OUTPUT_GAIN][FACTOR_LOG2]
+const std::array<TanhSaturator::KernelsByFactor, 8> TanhSaturator::kProcessKernels = {
+  kernelsFor<false, false, false>(),
+  kernelsFor<false, false, true>(),
+  kernelsFor<false, true, false>(),
+  kernelsFor<false, true, true>(),
+  kernelsFor<true, false, false>(),
+  kernelsFor<true, false, true>(),
+  kernelsFor<true, true, false>(),
+  kernelsFor<true, true, true>()
+};
+
+// Helper method - picks the process kernel for this vector. A stage is only left
+// out once its smoothed gains have settled, so ramps into the boundary values finish first.
+TanhSaturator::ProcessKernel TanhSaturator::selectProcessKernel() const {
+  const auto& dry = effectState.dryGain;
+  const auto& wet = effectState.wetGain;
+  const auto& output = effectState.outputGain;
+  bool mix = dry.isRamping() || wet.isRamping() || dry.getTarget() != 0.0f || wet.getTarget() != 1.0f;
+  bool filter = effectState.filterActive;
+  bool outputGain = output.isRamping() || output.getTarget() != 1.0f;
+
+  int flags = (mix ? 4 : 0) | (filter ? 2 : 0) | (outputGain ? 1 : 0);
+  return kProcessKernels[flags][effectState.stereoPack.oversampler.getFactorLog2()];
+}
+
+// Helper method - reads every parameter through its cached path and flags the ones that changed
+void TanhSaturator::readParams() {
+  TRACE_SCOPE("readParams", this);
+  const ParamPaths& paths = *paramCache.paths;
+  uint32_t toRead = ~0u;
+  if (paramCache.eventTracking) {
+    toRead = paramCache.changed.exchange(0, std::memory_order_relaxed);
+    for (int n = 0; n < ParamCache::kSweepPerVector; ++n) {
+      toRead |= 1u << paramCache.sweepNext;
+      paramCache.sweepNext = (paramCache.sweepNext + 1) % kNumParams;
+    }
+  }
+  for (int i = 0; i < kNumParams; ++i) {
+    if (!((toRead >> i) & 1u)) continue;
+    float value = this->getRealFloatParam(paths[i]);
+    if (value != paramCache.values[i]) {
+      paramCache.values[i] = value;
+      paramCache.markDirty(static_cast<ParamIndex>(i));
+    }
+  }
 }
 
-// Helper method - updates plugin activity state for CLAP sleep/continue
+// Helper method - recomputes state derived from dirty parameters
 void TanhSaturator::updateEffectState(float sampleRate) {
+  TRACE_SCOPE("updateEffectState", this);
   // Cache sample rate from AudioContext for use in DSP processing
-  effectState.sampleRate = sampleRate;
-  // Pre-compute inverse sample rate for fast frequency normalization (multiplication vs division)
-  effectState.inverseSampleRate = 1.0f / sampleRate;
-  // Determine if effect is active based on parameters
-  float inputGain = this->getRealFloatParam("input");
-  float outputGain = this->getRealFloatParam("output");
-  float dryWetMix = this->getRealFloatParam("dry_wet");
-  float lowpassQ = this->getRealFloatParam("lowpass_q");
-  
-  const float activityThreshold = 0.001f;
-  isActive = (inputGain > activityThreshold || outputGain > activityThreshold || dryWetMix > activityThreshold || lowpassQ > activityThreshold);
+  if (sampleRate != effectState.sampleRate) {
+    effectState.sampleRate = sampleRate;
+    // Pre-compute inverse sample rate for fast frequency normalization (multiplication vs division)
+    effectState.inverseSampleRate = 1.0f / sampleRate;
+    paramCache.markDirty(kLowpassParam);
+    paramCache.markDirty(kCrossoverLowParam);
+  }
+
+  // Parameter changes are smoothed over kSmoothingTime
+  int smoothingSamples = static_cast<int>(kSmoothingTime * effectState.sampleRate);
+  if (smoothingSamples != effectState.smoothingSamples) {
+    effectState.smoothingSamples = smoothingSamples;
+    effectState.inputGain.setRampSamples(smoothingSamples);
+    effectState.outputGain.setRampSamples(smoothingSamples);
+    effectState.dryGain.setRampSamples(smoothingSamples);
+    effectState.wetGain.setRampSamples(smoothingSamples);
+    for (int b = 0; b < dsp::kMaxBands; ++b) {
+      effectState.bandDrive[b].setRampSamples(smoothingSamples);
+      effectState.bandOutput[b].setRampSamples(smoothingSamples);
+    }
+  }
+
+  // Gains ramp toward their new values
+  if (paramCache.isDirty(kInputParam)) {
+    effectState.inputGain.setTarget(paramCache[kInputParam]);
+  }
+  if (paramCache.isDirty(kOutputParam)) {
+    effectState.outputGain.setTarget(paramCache[kOutputParam]);
+  }
+
+  // Select the tanh kernel tier
+  if (paramCache.isDirty(kQualityParam)) {
+    effectState.tanhQuality = dsp::tanhQualityFromParam(paramCache[kQualityParam]);
+  }
+
+  // Oversampling factor (as log2) and filter mode. Changing either resets the oversampler state.
+  const int oversamplingFactorLog2 = oversamplingFactorLog2FromParam(paramCache[kOversamplingParam]);
+  const auto oversamplingMode = oversamplingModeFromParam(paramCache[kOversamplingModeParam]);
+  if (paramCache.isDirty(kOversamplingParam) || paramCache.isDirty(kOversamplingModeParam)) {
+    forEachPack([&](auto& pack) {
+      pack.oversampler.setFactor(oversamplingFactorLog2);
+      pack.oversampler.setMode(oversamplingMode);
+      pack.forEachBandSaturation([&](auto& bands) {
+        bands.oversampler.setFactor(oversamplingFactorLog2);
+        bands.oversampler.setMode(oversamplingMode);
+      });
+    });
+  }
+
+  // Antiderivative anti-aliasing order
+  const auto adaaOrder = adaaOrderFromParam(paramCache[kAdaaParam]);
+  if (paramCache.isDirty(kAdaaParam)) {
+    forEachPack([&](auto& pack) {
+      pack.adaa.setOrder(adaaOrder);
+      pack.forEachBandSaturation([&](auto& bands) { bands.adaa.setOrder(adaaOrder); });
+    });
+  }
+
+  // The dry signal follows the wet path's delay. A new delay restarts the dry history.
+  if (paramCache.isDirty(kOversamplingParam) || paramCache.isDirty(kOversamplingModeParam) ||
+      paramCache.isDirty(kAdaaParam)) {
+    effectState.wetDelay = wetDelayFor(oversamplingFactorLog2, oversamplingMode, adaaOrder);
+    forEachPack([&](auto& pack) { pack.dryDelay.setDelay(effectState.wetDelay); });
+
+    // The host only compensates a new latency after restarting the plugin
+    if (hostRequestCallback && reportedLatency >= 0 && effectState.wetDelay != reportedLatency && !restartRequested) {
+      restartRequested = true;
+      hostRequestCallback(hostRequestContext, HostRequest::kRestart);
+    }
+  }
+
+  // Lowpass coefficients, only when frequency, Q or sample rate changed.
+  // The filter interpolates toward the new coefficients per sample.
+  if (paramCache.isDirty(kLowpassParam) || paramCache.isDirty(kLowpassQParam)) {
+    const dsp::SvfCoeffTable* table = effectState.lowpassTable.get();
+    if (table && table->getSampleRate() == effectState.sampleRate) {
+      // Ramp through the shared table, in log frequency and log Q
+      auto position = table->locate(paramCache[kLowpassParam], paramCache[kLowpassQParam]);
+      forEachPack([&](auto& pack) { pack.lowpass.setTarget(*table, position, effectState.smoothingSamples); });
+    } else {
+      // The host's rate differs from the one given to setSampleRate(), so there is
+      // no table for it: compute the coefficients directly.
+      // Use pre-computed inverse sample rate for fast frequency normalization (multiplication vs division)
+      float normalizedFreq = paramCache[kLowpassParam] * effectState.inverseSampleRate;
+      normalizedFreq = std::min(normalizedFreq, dsp::SvfCoeffTable::kMaxOmega);  // clamp below nyquist
+
+      // SvfCoeffs::make expects k = 1/Q, where k=0 is maximum resonance
+      float filterK = 1.0f / paramCache[kLowpassQParam];
+      auto coeffs = dsp::SvfCoeffs::make(normalizedFreq, filterK);
+      forEachPack([&](auto& pack) { pack.lowpass.setTarget(coeffs, effectState.smoothingSamples); });
+    }
+  }
+
+  // Crossover bands and frequencies. The frequencies are kept in ascending order
+  // and below Nyquist, and ramp through the lowpass table like the cutoff.
+  // Switching the band count restarts the band state.
+  if (paramCache.isDirty(kBandsParam) || paramCache.isDirty(kCrossoverLowParam) ||
+      paramCache.isDirty(kCrossoverMidParam) || paramCache.isDirty(kCrossoverHighParam)) {
+    int bands = std::max(1, std::min(dsp::kMaxBands, static_cast<int>(paramCache[kBandsParam] + 0.5f)));
+    const ParamIndex crossoverParams[dsp::kMaxBands - 1] = { kCrossoverLowParam, kCrossoverMidParam, kCrossoverHighParam };
+    float omegas[dsp::kMaxBands - 1];
+    float hz[dsp::kMaxBands - 1];
+    float previous = 0.0f;
+    for (int s = 0; s < bands - 1; ++s) {
+      float omega = paramCache[crossoverParams[s]] * effectState.inverseSampleRate;
+      omegas[s] = previous = std::max(previous, std::min(omega, dsp::SvfCoeffTable::kMaxOmega));
+      hz[s] = omegas[s] * effectState.sampleRate;
+    }
+    if (bands != effectState.bands) {
+      forEachPack([](auto& pack) {
+        pack.forEachBandSaturation([](auto& bands) {
+          bands.oversampler.reset();
+          bands.adaa.reset();
+        });
+      });
+      effectState.bands = bands;
+    }
+    const dsp::SvfCoeffTable* table = effectState.lowpassTable.get();
+    if (table && table->getSampleRate() == effectState.sampleRate) {
+      forEachPack([&](auto& pack) { pack.crossover.setBands(bands, *table, hz, effectState.smoothingSamples); });
+    } else {
+      forEachPack([&](auto& pack) { pack.crossover.setBands(bands, omegas); });
+    }
+  }
+  if (effectState.bands > 1 && !effectState.bandStatesReady) {
+    takeUpBandStates(oversamplingFactorLog2, oversamplingMode, adaaOrder);
+  }
+
+  // Stereo processing mode. The lanes of the stereo pack change meaning, so its state is cleared.
+  if (paramCache.isDirty(kStereoModeParam)) {
+    auto stereoMode = static_cast<StereoMode>(std::max(0, std::min(3, static_cast<int>(paramCache[kStereoModeParam] + 0.5f))));
+    if (stereoMode != effectState.stereoMode) {
+      effectState.stereoMode = stereoMode;
+      effectState.stereoPack.clearState();
+    }
+  }
+
+  // Linear or saturating lowpass feedback
+  if (paramCache.isDirty(kLowpassModeParam)) {
+    auto lowpassMode = paramCache[kLowpassModeParam] > 0.5f ? dsp::SvfMode::kNonlinear : dsp::SvfMode::kLinear;
+    forEachPack([&](auto& pack) { pack.lowpass.setMode(lowpassMode); });
+  }
+
+  // Per-band drive and output gains
+  for (int b = 0; b < dsp::kMaxBands; ++b) {
+    if (paramCache.isDirty(static_cast<ParamIndex>(kBand1DriveParam + b))) {
+      effectState.bandDrive[b].setTarget(paramCache[static_cast<ParamIndex>(kBand1DriveParam + b)]);
+    }
+    if (paramCache.isDirty(static_cast<ParamIndex>(kBand1OutputParam + b))) {
+      effectState.bandOutput[b].setTarget(paramCache[static_cast<ParamIndex>(kBand1OutputParam + b)]);
+    }
+  }
+
+  // Bypass the lowpass at the top of its range once it has finished ramping there.
+  // Its state is cleared so it starts from silence when it comes back in.
+  bool ramping = withLeadPack([](const auto& pack) { return pack.lowpass.isRamping(); });
+  bool filterActive = paramCache[kLowpassParam] < kLowpassMaxFrequency * 0.999f || ramping;
+  if (effectState.filterActive && !filterActive) {
+    forEachPack([](auto& pack) { pack.lowpass.clearState(); });
+  }
+  effectState.filterActive = filterActive;
+
+  // Dry/wet gains
+  if (paramCache.isDirty(kDryWetParam)) {
+    float wetNorm = paramCache[kDryWetParam];
+    float dryGain = 1.0f - wetNorm * wetNorm;
+    effectState.dryGain.setTarget(dryGain);
+    effectState.wetGain.setTarget(1.0f - dryGain);
+  }
+
+  // The tail depends on the lowpass, the sample rate and the oversampler and ADAA histories
+  if (paramCache.isDirty(kLowpassParam) || paramCache.isDirty(kLowpassQParam) ||
+      paramCache.isDirty(kOversamplingParam) || paramCache.isDirty(kOversamplingModeParam) ||
+      paramCache.isDirty(kAdaaParam)) {
+    const uint32_t tail = getTailSamples();
+    if (tail != currentTail.load(std::memory_order_relaxed)) {
+      currentTail.store(tail, std::memory_order_relaxed);
+      if (hostRequestCallback) hostRequestCallback(hostRequestContext, HostRequest::kTailChanged);
+    }
+  }
+}
+
+// Helper method - updates plugin activity state for CLAP sleep/continue.
+// Silence on the input alone is not enough: the oversampler and ADAA still hold
+// recent samples, and a resonant lowpass keeps ringing. The plugin goes inactive
+// once the input has been silent long enough to flush those histories and the
+// filter state has decayed below the silence threshold.
+void TanhSaturator::updateActivity(const ml::DSPVectorDynamic& inputs, size_t channels) {
+  float inputPeak = 0.0f;
+  for (size_t c = 0; c < channels; ++c) {
+    inputPeak = std::max(inputPeak, dsp::peakAbs(inputs[c]));
+  }
+  if (inputPeak > kSilenceThreshold) {
+    effectState.silentSamples = 0;
+  } else if (effectState.silentSamples < std::numeric_limits<int>::max() - static_cast<int>(ml::kFloatsPerDSPVector)) {
+    effectState.silentSamples += static_cast<int>(ml::kFloatsPerDSPVector);
+  }
+
+  bool flushing = effectState.silentSamples < getFlushSamples();
+  float stateMagnitude = 0.0f;
+  float crossoverMagnitude = 0.0f;
+  forEachPack([&](const auto& pack) {
+    stateMagnitude = std::max(stateMagnitude, pack.lowpass.getStateMagnitude());
+    crossoverMagnitude = std::max(crossoverMagnitude, pack.crossover.getStateMagnitude());
+  });
+  bool ringing = (effectState.filterActive && stateMagnitude > kSilenceThreshold) ||
+                 (effectState.bands > 1 && crossoverMagnitude > kSilenceThreshold);
+  isActive = flushing || ringing;
+}
+
+size_t TanhSaturator::bufferChannels(const ml::DSPVectorDynamic& inputs, const ml::DSPVectorDynamic& outputs) const {
+  return std::min({ static_cast<size_t>(effectState.channelCount), inputs.size(), outputs.size() });
+}
+
+// Helper method - samples of silent input needed to clear the oversampler and ADAA
+// histories. Silence is detected per DSPVector, so this is at least one vector.
+int TanhSaturator::getFlushSamples() const {
+  // The FIR histories span about twice the oversampler's latency; ADAA adds at most two samples.
+  const int oversamplerLatency = withLeadPack([](const auto& pack) { return pack.oversampler.getLatency(); });
+  return 2 * oversamplerLatency + 2 + static_cast<int>(ml::kFloatsPerDSPVector);
+}
+
+uint32_t TanhSaturator::getLatencySamples() {
+  const ParamPaths& paths = *paramCache.paths;
+  const int factorLog2 = oversamplingFactorLog2FromParam(this->getRealFloatParam(paths[kOversamplingParam]));
+  const auto mode = oversamplingModeFromParam(this->getRealFloatParam(paths[kOversamplingModeParam]));
+  const auto order = adaaOrderFromParam(this->getRealFloatParam(paths[kAdaaParam]));
+  return static_cast<uint32_t>(wetDelayFor(factorLog2, mode, order));
+}
+
+int TanhSaturator::wetDelayFor(int factorLog2, dsp::OversamplingMode mode, dsp::AdaaOrder order) {
+  // The ADAA runs at the oversampled rate
+  const float delay = dsp::Oversampler<2>::delayFor(factorLog2, mode) +
+                      dsp::TanhAdaa<2>::delayFor(order) / static_cast<float>(1 << factorLog2);
+  return static_cast<int>(delay + 0.5f);
+}
+
+uint32_t TanhSaturator::getTailSamples() const {
+  // Worst case: a full-scale wet signal, boosted by the filter's resonant peak
+  // (about Q = 1/k), decaying to the silence threshold. A ramp in progress is
+  // taken at its end, where the filter will ring.
+  const dsp::SvfCoeffs coeffs = withLeadPack([](const auto& pack) { return pack.lowpass.getTargetCoeffs(); });
+  float peak = std::max(1.0f, 1.0f / std::max(coeffs.k, 1e-3f));
+  int maxSamples = static_cast<int>(kMaxTailTime * effectState.sampleRate);
+  return static_cast<uint32_t>(getFlushSamples() + coeffs.samplesToDecay(peak, kSilenceThreshold, maxSamples));
 }
 
 // Plugin-specific implementation - defines parameters using madronalib ParameterTree system
 void TanhSaturator::buildParameterDescriptions() {
-  ml::ParameterDescriptionList params;
+  // The descriptions are the same for every instance, so they are built once per
+  // process and shared; each instance's parameter tree is then built from them.
+  parameterDescriptions = dsp::SharedResource<ml::ParameterDescriptionList>::acquire(0, makeParameterDescriptions);
+  this->buildParams(*parameterDescriptions);
+
+  // this might be unnecessary
+  this->setDefaultParams();
+}
+
+std::unique_ptr<TanhSaturator::ParamPaths> TanhSaturator::makeParamPaths() {
+  auto paths = std::make_unique<ParamPaths>();
+  for (int i = 0; i < kNumParams; ++i) {
+    (*paths)[i] = ml::Path(kParamNames[i]);
+  }
+  return paths;
+}
+
+std::unique_ptr<ml::ParameterDescriptionList> TanhSaturator::makeParameterDescriptions() {
+  auto descriptions = std::make_unique<ml::ParameterDescriptionList>();
+  ml::ParameterDescriptionList& params = *descriptions;
 
   // Input gain
   params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
@@ -174,7 +812,7 @@ void TanhSaturator::buildParameterDescriptions() {
   // TODO: does log=true use default or plaindefault? default works properly here, but why does our `input` param work with `plaindefault` of 2.2? which is normalized?
   params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
     {"name", "lowpass"},
-    {"range", {50.0f, 20000.0f}},
+    {"range", {50.0f, kLowpassMaxFrequency}},
     {"default", 1500.0f},
     {"units", "Hz"},
     {"log", true}
@@ -188,8 +826,98 @@ void TanhSaturator::buildParameterDescriptions() {
     {"units", ""}
   }));
 
-  this->buildParams(params);
+  // Saturation quality: 0 = draft (polynomial), 1 = standard (Pade),
+  // 2 = high (table), 3 = reference (exp). See dsp/FastTanh.h for error bounds.
+  params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+    {"name", "quality"},
+    {"range", {0.0f, 3.0f}},
+    {"plaindefault", 1.0f},
+    {"units", ""}
+  }));
 
-  // this might be unnecessary
-  this->setDefaultParams();
+  // Oversampling around the saturator: 0 = off, 1 = 2x, 2 = 4x, 3 = 8x
+  params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+    {"name", "oversampling"},
+    {"range", {0.0f, 3.0f}},
+    {"plaindefault", 0.0f},
+    {"units", ""}
+  }));
+
+  // Oversampling filters: 0 = linear phase (adds latency), 1 = minimum phase
+  params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+    {"name", "oversampling_mode"},
+    {"range", {0.0f, 1.0f}},
+    {"plaindefault", 0.0f},
+    {"units", ""}
+  }));
+
+  // Antiderivative anti-aliasing: 0 = off, 1 = first order, 2 = second order
+  params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+    {"name", "adaa"},
+    {"range", {0.0f, 2.0f}},
+    {"plaindefault", 0.0f},
+    {"units", ""}
+  }));
+
+  // Multiband saturation: 1 = broadband, 2 to 4 = Linkwitz-Riley bands
+  params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+    {"name", "bands"},
+    {"range", {1.0f, 4.0f}},
+    {"plaindefault", 1.0f},
+    {"units", ""}
+  }));
+
+  // Crossover frequencies, from the lowest split up. Only the first bands - 1 are used.
+  const std::pair<const char*, float> crossovers[] = {
+    { "crossover_low", 200.0f },
+    { "crossover_mid", 1000.0f },
+    { "crossover_high", 5000.0f }
+  };
+  for (const auto& crossover : crossovers) {
+    params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+      {"name", crossover.first},
+      {"range", {50.0f, kLowpassMaxFrequency}},
+      {"default", crossover.second},
+      {"units", "Hz"},
+      {"log", true}
+    }));
+  }
+
+  // Per-band drive, multiplying the input gain, and output gain, from the lowest band up
+  for (const char* name : { "band1_drive", "band2_drive", "band3_drive", "band4_drive" }) {
+    params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+      {"name", name},
+      {"range", {0.0f, 4.0f}},
+      {"plaindefault", 1.0f},
+      {"units", ""}
+    }));
+  }
+  for (const char* name : { "band1_output", "band2_output", "band3_output", "band4_output" }) {
+    params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+      {"name", name},
+      {"range", {0.0f, 2.0f}},
+      {"plaindefault", 1.0f},
+      {"units", ""}
+    }));
+  }
+
+  // Stereo processing: 0 = left/right, 1 = mid/side, 2 = mid only, 3 = side only.
+  // Only used with the stereo channel layout.
+  params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+    {"name", "stereo_mode"},
+    {"range", {0.0f, 3.0f}},
+    {"plaindefault", 0.0f},
+    {"units", ""}
+  }));
+
+  // Lowpass feedback: 0 = linear, 1 = nonlinear (tanh on the bandpass state, which
+  // keeps high-Q resonance near full scale)
+  params.push_back(std::make_unique<ml::ParameterDescription>(ml::WithValues{
+    {"name", "lowpass_mode"},
+    {"range", {0.0f, 1.0f}},
+    {"plaindefault", 0.0f},
+    {"units", ""}
+  }));
+
+  return descriptions;
 }
@@ -1,14 +1,126 @@
 #pragma once
 
 #include "../external/madronalib/include/CLAPExport.h"  // Includes madronalib core + CLAPSignalProcessor base class
+#include "AnalyzerTap.h"
+#include "dsp/Crossover.h"
+#include "dsp/FastTanh.h"
+#include "dsp/Oversampler.h"
+#include "dsp/ParamRamp.h"
+#include "dsp/SharedResource.h"
+#include "dsp/Svf.h"
+#include "dsp/TanhAdaa.h"
+#include "dsp/VectorDelay.h"
+#include "Telemetry.h"
+#include "Trace.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 #ifdef HAS_GUI
 class TanhSaturatorGUI;
 #endif
 
 class TanhSaturator : public ml::CLAPSignalProcessor<> {
+public:
+  // Channel layouts offered to the host through the CLAP audio-ports-config
+  // extension. Input and output always have the same layout.
+  struct ChannelConfig {
+    const char* name;
+    int channels;
+  };
+  static constexpr int kNumChannelConfigs = 5;
+  static const ChannelConfig kChannelConfigs[kNumChannelConfigs];
+
+  // Largest supported channel count (9.1.6)
+  static constexpr int kMaxChannels = 16;
+
+  // Channels advanced together in one SIMD register by the wide packs
+  static constexpr size_t kWidePackLanes = 4;
+
+  // Requests made of the host from the audio thread, see PluginExtensions.h
+  // kMainThreadCallback asks for onMainThread() to be called.
+  enum class HostRequest { kRestart, kTailChanged, kMainThreadCallback };
+  using HostRequestCallback = void (*)(void* context, HostRequest request);
+
 private:
 
+  // Oversampler and ADAA state for N lanes of multiband saturation
+  template <size_t N>
+  struct BandSaturation {
+    dsp::Oversampler<N> oversampler;
+    dsp::TanhAdaa<N> adaa;
+  };
+
+  // DSP state for LANES channels processed together as one DSPVectorArray<LANES>.
+  // Each object keeps its per-channel state in arrays indexed by lane.
+  template <size_t LANES>
+  struct ChannelPack {
+    // State variable lowpass (same response as ml::Lopass) with per-sample coefficient ramps,
+    // switching its recursion to 64-bit arithmetic by itself at low cutoffs and high Q,
+    // with linear or saturating feedback as set by "lowpass_mode"
+    dsp::SvfLowpass<LANES> lowpass;
+
+    // Oversampler wrapped around the saturation stage
+    dsp::Oversampler<LANES> oversampler;
+
+    // Antiderivative anti-aliasing state
+    dsp::TanhAdaa<LANES> adaa;
+
+    // The dry signal, delayed to line up with the wet path, see wetDelayFor()
+    dsp::VectorDelay<LANES> dryDelay;
+
+    // Multiband mode: the crossover splits the pack into bands, which are then
+    // saturated together with one lane per band and channel. Two bands have their
+    // own state so they don't pay for the silent lanes of four; three bands use
+    // the state for four.
+    dsp::Crossover<LANES> crossover;
+    struct BandStates {
+      BandSaturation<LANES * 2> twoBands;
+      BandSaturation<LANES * dsp::kMaxBands> fourBands;
+    };
+
+    // The band states are most of a pack's size, so they are only allocated once
+    // more than one band is selected, on the main thread, see allocateBandStates().
+    // bandStorage belongs to the main thread; the audio thread finds the states
+    // through bandStates and starts using them once it has configured them.
+    std::unique_ptr<BandStates> bandStorage;
+    std::atomic<BandStates*> bandStates{ nullptr };
+    bool bandStatesConfigured = false;
+
+    // The band states in use by the audio thread, or null
+    BandStates* activeBandStates() const {
+      return bandStatesConfigured ? bandStates.load(std::memory_order_relaxed) : nullptr;
+    }
+
+    template <class F>
+    void forEachBandSaturation(F&& f) {
+      if (BandStates* states = activeBandStates()) {
+        f(states->twoBands);
+        f(states->fourBands);
+      }
+    }
+
+    // Silences every filter and history, keeping settings and lowpass coefficients
+    void clearState() {
+      lowpass.clearState();
+      oversampler.reset();
+      adaa.reset();
+      crossover.clearState();
+      dryDelay.reset();
+      forEachBandSaturation([](auto& bands) {
+        bands.oversampler.reset();
+        bands.adaa.reset();
+      });
+    }
+  };
+
+  // How a stereo pair is processed. The modes other than kLeftRight encode to mid
+  // and side on the way in and decode on the way out. kMidOnly and kSideOnly leave
+  // the other signal out of the saturator and the lowpass.
+  enum class StereoMode { kLeftRight = 0, kMidSide, kMidOnly, kSideOnly };
+
   // EffectState holds a per-instance processing state for the effect.
   // For simple stateless effects like tanh saturation, this struct may remain empty.
   // More complex effects (such as loopers, delays, or reverbs) can store their
@@ -23,21 +135,171 @@ private:
   //   - GUI state, pointers to the audio context, or references to external systems.
   //   - Large static tables or resources that can be shared across instances (these should be static or global).
   struct EffectState {
-    // Lowpass filters for left and right channels
-    // Lopass filters (State Variable Filter) following CLAP saw demo pattern
-    ml::Lopass lowpassL;
-    ml::Lopass lowpassR;
+    // Channels are processed kWidePackLanes at a time by the wide packs. A
+    // remainder of one or two channels, which includes plain stereo, runs on
+    // stereoPack; a remainder of three gets one more wide pack with a silent lane.
+    // Every pack follows the current settings, used or not.
+    ChannelPack<2> stereoPack;
+    std::vector<std::unique_ptr<ChannelPack<kWidePackLanes>>> widePacks;
+    int channelCount = 2;
+    bool stereoPackUsed = true;
+
+    // Applies to the stereo layout only
+    StereoMode stereoMode = StereoMode::kLeftRight;
+
+    // Lowpass coefficients over the cutoff and Q ranges at the current sample rate,
+    // shared with other instances running at the same rate
+    std::shared_ptr<const dsp::SvfCoeffTable> lowpassTable;
     
     // Cached sample rate from AudioContext (updated in updateEffectState)
     float sampleRate = 44100.0f;
     // Pre-computed inverse sample rate for fast frequency normalization
     float inverseSampleRate = 1.0f / 44100.0f;
+
+    // tanh kernel tier selected by the "quality" parameter
+    dsp::TanhQuality tanhQuality = dsp::TanhQuality::kStandard;
+
+    // Delay of the wet path in samples, matched by the dry delay
+    int wetDelay = 0;
+
+    // Smoothed gains. Parameter changes ramp linearly across the vector
+    // instead of stepping once per DSPVector.
+    dsp::LinearRamp inputGain;
+    dsp::LinearRamp outputGain;
+    dsp::LinearRamp dryGain;
+    dsp::LinearRamp wetGain;
+
+    // Number of crossover bands, 1 for broadband saturation, and the smoothed
+    // drive and output gain of each band. Until every pack's band states are in
+    // use, more than one band is processed as broadband.
+    int bands = 1;
+    bool bandStatesReady = false;
+    std::array<dsp::LinearRamp, dsp::kMaxBands> bandDrive;
+    std::array<dsp::LinearRamp, dsp::kMaxBands> bandOutput;
+
+    // Length of parameter and coefficient ramps in samples
+    int smoothingSamples = 0;
+
+    // Consecutive input samples below kSilenceThreshold, for CLAP sleep/continue
+    int silentSamples = 0;
+
+    // False while the lowpass sits at the top of its range and is bypassed
+    bool filterActive = true;
   };
+
+  // Calls f on every allocated ChannelPack, stereo first
+  template <class F>
+  void forEachPack(F&& f) {
+    f(effectState.stereoPack);
+    for (auto& pack : effectState.widePacks) f(*pack);
+  }
+
+  template <class F>
+  void forEachPack(F&& f) const {
+    f(effectState.stereoPack);
+    for (const auto& pack : effectState.widePacks) f(*pack);
+  }
+
+  // Calls f on the first pack that is processed. All packs get the same settings and
+  // advance together, so its lowpass ramp and coefficients stand for all of them.
+  template <class F>
+  auto withLeadPack(F&& f) const {
+    if (effectState.stereoPackUsed) return f(effectState.stereoPack);
+    return f(*effectState.widePacks.front());
+  }
+
+  // Time over which parameter changes are smoothed, in seconds
+  static constexpr float kSmoothingTime = 0.02f;
+  // Input and filter state below this level (-100 dB) count as silence
+  static constexpr float kSilenceThreshold = 1e-5f;
+  // Top of the lowpass range. At this setting the filter is bypassed.
+  static constexpr float kLowpassMaxFrequency = 20000.0f;
+  // Upper bound on the reported tail, in seconds, for Q settings that barely decay
+  static constexpr float kMaxTailTime = 10.0f;
   EffectState effectState;
 
-  // Track if effect is active for CLAP sleep/continue
+  // Parameters read by the process path, in the order of kParamNames.
+  enum ParamIndex {
+    kInputParam = 0,
+    kOutputParam,
+    kDryWetParam,
+    kLowpassParam,
+    kLowpassQParam,
+    kQualityParam,
+    kOversamplingParam,
+    kOversamplingModeParam,
+    kAdaaParam,
+    kBandsParam,
+    kCrossoverLowParam,
+    kCrossoverMidParam,
+    kCrossoverHighParam,
+    kBand1DriveParam,
+    kBand2DriveParam,
+    kBand3DriveParam,
+    kBand4DriveParam,
+    kBand1OutputParam,
+    kBand2OutputParam,
+    kBand3OutputParam,
+    kBand4OutputParam,
+    kStereoModeParam,
+    kLowpassModeParam,
+    kNumParams
+  };
+  static const char* const kParamNames[kNumParams];
+
+  using ParamPaths = std::array<ml::Path, kNumParams>;
+
+  // ParamCache reads each parameter through a path resolved once per process,
+  // keeps the last value read and sets a dirty bit when it changes. Derived state
+  // such as filter coefficients is only recomputed for parameters whose bit is set.
+  //
+  // With event tracking on, only the parameters marked as changed since the last
+  // vector are read, plus kSweepPerVector others in turn, which picks up changes
+  // no event reported within kNumParams / kSweepPerVector vectors. Without it,
+  // as offline, every parameter is read every vector.
+  static_assert(kNumParams <= 32, "ParamCache keeps one bit per parameter in a uint32_t");
+  struct ParamCache {
+    static constexpr int kSweepPerVector = 2;
+
+    std::shared_ptr<const ParamPaths> paths;
+    std::array<float, kNumParams> values;
+    uint32_t dirty = ~0u;
+
+    // Marked from any thread, taken by readParams()
+    std::atomic<uint32_t> changed{ ~0u };
+    bool eventTracking = false;
+    int sweepNext = 0;
+
+    float operator[](ParamIndex i) const { return values[i]; }
+    bool isDirty(ParamIndex i) const { return (dirty >> i) & 1u; }
+    void markDirty(ParamIndex i) { dirty |= 1u << i; }
+  };
+  ParamCache paramCache;
+
+  // Parameter descriptions shared by all instances in the process, see buildParameterDescriptions()
+  std::shared_ptr<const ml::ParameterDescriptionList> parameterDescriptions;
+
+  // Per-block timing and levels for the GUI's CPU meter, see Telemetry.h
+  BlockTelemetry telemetry;
+
+  // Decimated output and settings for the GUI's analyzer, see AnalyzerTap.h
+  AnalyzerTap analyzer;
+
+  // Track if effect is active for CLAP sleep/continue.
+  // Set while the input is non-silent or the output is still ringing out.
   bool isActive = false;
 
+  // Host requests, and the latency the host was last told. A different latency
+  // while processing requests one restart. -1 until a host reports one.
+  HostRequestCallback hostRequestCallback = nullptr;
+  void* hostRequestContext = nullptr;
+  int reportedLatency = -1;
+  bool restartRequested = false;
+  bool mainThreadCallbackRequested = false;
+
+  // getTailSamples() as of the last settings change, readable from any thread
+  std::atomic<uint32_t> currentTail{ 0 };
+
 public:
   TanhSaturator();
   ~TanhSaturator() = default;
@@ -48,17 +310,149 @@ public:
 
   void processVector(const ml::DSPVectorDynamic& inputs, ml::DSPVectorDynamic& outputs, void* stateData = nullptr) override;
 
+  // Selects the number of input and output channels, from 1 to kMaxChannels.
+  // Allocates, so call it from the main thread while processing is stopped, as
+  // when the host applies an audio-ports config. The default is stereo.
+  void setChannelCount(int channels);
+  int getChannelCount() const { return effectState.channelCount; }
+
   // Effect activity for CLAP sleep/continue
   bool hasActiveVoices() const override { return isActive; }
 
+  // Processing latency in samples for the CLAP latency extension.
+  // Changes with the oversampling factor and mode and the ADAA order. Computed from
+  // the parameters, so it is right before the first processVector() as well.
+  uint32_t getLatencySamples();
+
+  // Delay of the wet path in samples for the given settings: the oversampler's filters
+  // plus the ADAA delay at the oversampled rate, rounded to whole samples. The dry
+  // signal is delayed by the same amount so the mix doesn't comb-filter.
+  static int wetDelayFor(int factorLog2, dsp::OversamplingMode mode, dsp::AdaaOrder order);
+
+  // Main thread, while processing is stopped
+  void setHostRequestCallback(HostRequestCallback callback, void* context) {
+    hostRequestCallback = callback;
+    hostRequestContext = context;
+  }
+  void setReportedLatency(uint32_t samples) {
+    reportedLatency = static_cast<int>(samples);
+    restartRequested = false;
+  }
+
+  // Main thread, after a kMainThreadCallback request
+  void onMainThread() { allocateBandStates(); }
+
+  // Allocates the multiband state of every pack that has none. Main thread; the
+  // audio thread picks the states up on its next processVector(). Without a host
+  // to call onMainThread(), as offline, processVector() calls it itself.
+  void allocateBandStates();
+
+  // Tail length in samples: the longest the output can keep sounding after the
+  // input goes silent, for the current lowpass and oversampling settings.
+  uint32_t getTailSamples() const;
+
+  // getTailSamples() as of the last processVector() that changed it, for the CLAP
+  // tail extension, which may ask from any thread. Each change is also sent as a
+  // kTailChanged request from the audio thread.
+  uint32_t getCurrentTailSamples() const { return currentTail.load(std::memory_order_relaxed); }
+
   // Plugin-specific interface
   const ml::ParameterTree& getParameterTree() const { return this->_params; }
 
+  // Telemetry channel drained by the GUI. Only the GUI thread may call pop() or setEnabled().
+  BlockTelemetry& getTelemetry() { return telemetry; }
+
+  // Analyzer channel drained by the GUI, with the same threading rules as the telemetry
+  AnalyzerTap& getAnalyzerTap() { return analyzer; }
+
+  // True if name is one of the parameters defined in buildParameterDescriptions()
+  static bool isParamName(const char* name);
+
+  // Index of the parameter called name for markParamChanged(), or -1
+  static int paramIndex(const char* name);
+  static int getNumParams() { return kNumParams; }
+
+  // Reads only the parameters marked as changed, plus a slow sweep of the rest,
+  // instead of every parameter every vector. For hosts that report every change
+  // as an event, see PluginExtensions.h. Main thread, while processing is stopped.
+  void setParamEventTracking(bool enabled) { paramCache.eventTracking = enabled; }
+
+  // Any thread: the parameter is read again on the next processVector()
+  void markParamChanged(int index) {
+    if (index >= 0 && index < kNumParams) paramCache.changed.fetch_or(1u << index, std::memory_order_relaxed);
+  }
+  void markAllParamsChanged() { paramCache.changed.store(~0u, std::memory_order_relaxed); }
+
+  // Clears all processing state and settles parameter ramps on their current targets,
+  // so the next processVector() starts from silence with no smoothing in progress.
+  // Used by the offline renderer between files.
+  void resetProcessingState();
+
 private:
+  // Process kernels specialized at compile time, so stages that are inactive for
+  // the current settings are left out instead of being evaluated as no-ops:
+  //   MIX          dry/wet mix, off when fully wet
+  //   FILTER       post-saturation lowpass, off at the top of its range
+  //   OUTPUT_GAIN  output gain multiply, off at unity
+  //   FACTOR_LOG2  oversampling factor
+  // selectProcessKernel() picks one per DSPVector from kProcessKernels.
+  using ProcessKernel = void (TanhSaturator::*)(const ml::DSPVectorDynamic&, ml::DSPVectorDynamic&);
+  static constexpr int kNumFactors = dsp::Oversampler<2>::kMaxFactorLog2 + 1;
+  using KernelsByFactor = std::array<ProcessKernel, kNumFactors>;
+  static const std::array<KernelsByFactor, 8> kProcessKernels;
+  template <bool MIX, bool FILTER, bool OUTPUT_GAIN>
+  static constexpr KernelsByFactor kernelsFor();
+  ProcessKernel selectProcessKernel() const;
+
+  // Smoothed gains for one DSPVector, shared by all channels. With MIX, wet
+  // includes the output gain; without it, wet is the output gain alone.
+  // The band gains are only filled in multiband mode.
+  struct VectorGains {
+    ml::DSPVector input;
+    ml::DSPVector dry;
+    ml::DSPVector wet;
+    std::array<ml::DSPVector, dsp::kMaxBands> bandDrive;
+    std::array<ml::DSPVector, dsp::kMaxBands> bandOutput;
+  };
+
+  template <bool MIX, bool FILTER, bool OUTPUT_GAIN, int FACTOR_LOG2>
+  void processEffect(const ml::DSPVectorDynamic& inputs, ml::DSPVectorDynamic& outputs);
+
+  // Channels first to first + count - 1 through one pack; lanes from count on are silent
+  template <bool MIX, bool FILTER, bool OUTPUT_GAIN, int FACTOR_LOG2, size_t LANES>
+  void processPack(ChannelPack<LANES>& pack, const ml::DSPVectorDynamic& inputs, ml::DSPVectorDynamic& outputs,
+                   size_t first, size_t count, const VectorGains& gains);
+
+  // Builds the descriptions of every parameter, called once per process
+  static std::unique_ptr<ml::ParameterDescriptionList> makeParameterDescriptions();
+  static std::unique_ptr<ParamPaths> makeParamPaths();
+
   // Helper methods for effect processing
-  void processStereoEffect(ml::DSPVector& leftChannel, ml::DSPVector& rightChannel);
+  void readParams();
   void updateEffectState(float sampleRate);
+  void takeUpBandStates(int factorLog2, dsp::OversamplingMode mode, dsp::AdaaOrder order);
+  void updateActivity(const ml::DSPVectorDynamic& inputs, size_t channels);
+  // Channels to process: the layout's, or fewer if the buffers are short
+  size_t bufferChannels(const ml::DSPVectorDynamic& inputs, const ml::DSPVectorDynamic& outputs) const;
+  void writeAnalyzer(const ml::DSPVector& leftInput, const ml::DSPVector& rightInput,
+                     const ml::DSPVector& leftOutput, const ml::DSPVector& rightOutput);
+  int getFlushSamples() const;
   
-  // Tanh saturation algorithm
-  ml::DSPVector processTanhSaturation(const ml::DSPVector& inputSamples, float inputGain, float outputGain);
+  // Tanh saturation algorithm, run in place on every lane of a pack at the oversampler's rate
+  template <int FACTOR_LOG2, size_t LANES>
+  void processTanhSaturation(ChannelPack<LANES>& pack, ml::DSPVectorArray<LANES>& samples, uint32_t bypassLanes);
+
+  // Multiband saturation: split, drive and saturate every band in one pass, then sum the bands
+  template <int FACTOR_LOG2, size_t LANES>
+  void processMultibandSaturation(ChannelPack<LANES>& pack, ml::DSPVectorArray<LANES>& samples,
+                                  const VectorGains& gains, uint32_t bypassLanes);
+  template <int BANDS, int FACTOR_LOG2, size_t LANES>
+  void processBands(ChannelPack<LANES>& pack, BandSaturation<LANES * BANDS>& state,
+                    ml::DSPVectorArray<LANES>& samples, const VectorGains& gains, uint32_t bypassLanes);
+
+  // The saturator itself on any number of lanes, with the given oversampler and ADAA state.
+  // Lanes set in bypassLanes go through the oversampler's filters but not the saturator.
+  template <int FACTOR_LOG2, size_t N>
+  void saturate(dsp::Oversampler<N>& oversampler, dsp::TanhAdaa<N>& adaa, ml::DSPVectorArray<N>& samples,
+                uint32_t bypassLanes);
 };
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "MLDSPOps.h"
+#include "SpscRing.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+// Audio-thread telemetry for the GUI: per-block processing time, a per-stage
+// breakdown and output levels, passed through a wait-free single-producer /
+// single-consumer ring. The audio side never allocates or locks; when the ring
+// is full, new frames are dropped rather than waiting for the reader.
+
+// Stages timed within one processed block
+enum TelemetryStage { kSaturationStage = 0, kFilterStage, kMixStage, kNumTelemetryStages };
+
+// One processed DSPVector
+struct TelemetryFrame {
+  float blockMicros = 0.0f;   // time spent in processVector
+  float budgetMicros = 0.0f;  // duration of the audio in the block
+  float stageMicros[kNumTelemetryStages] = {};
+  float peak[2] = {};
+  float rms[2] = {};
+
+  // Fraction of the real-time budget used, 1 = the audio thread is fully loaded
+  float load() const { return budgetMicros > 0.0f ? blockMicros / budgetMicros : 0.0f; }
+};
+
+// Collects one TelemetryFrame per block on the audio thread while enabled.
+// Disabled (the default, and whenever no GUI is open) it costs one relaxed load per block.
+// The ring is allocated when a GUI first enables it, so instances whose editor is
+// never opened don't carry it.
+class BlockTelemetry {
+public:
+  static constexpr size_t kCapacity = 1024;
+  using Clock = std::chrono::steady_clock;
+  using Ring = SpscRing<TelemetryFrame, kCapacity>;
+
+  // Called from the GUI thread when a view opens or closes
+  void setEnabled(bool enabled) {
+    if (enabled && !_ringStorage) {
+      _ringStorage = std::make_unique<Ring>();
+      _ring.store(_ringStorage.get(), std::memory_order_release);
+    }
+    _enabled.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Audio thread
+  void beginBlock() {
+    _active = _enabled.load(std::memory_order_relaxed) && _ring.load(std::memory_order_acquire);
+    if (!_active) return;
+    _frame = TelemetryFrame();
+    _blockStart = _stageStart = Clock::now();
+  }
+
+  void endStage(TelemetryStage stage) {
+    if (!_active) return;
+    auto now = Clock::now();
+    _frame.stageMicros[stage] += micros(_stageStart, now);
+    _stageStart = now;
+  }
+
+  void endBlock(const ml::DSPVector& left, const ml::DSPVector& right, float sampleRate) {
+    if (!_active) return;
+    _frame.blockMicros = micros(_blockStart, Clock::now());
+    _frame.budgetMicros = 1e6f * static_cast<float>(ml::kFloatsPerDSPVector) / sampleRate;
+    measureLevels(left, 0);
+    measureLevels(right, 1);
+    _ring.load(std::memory_order_relaxed)->push(_frame);
+  }
+
+  // GUI thread
+  bool pop(TelemetryFrame& frame) { return _ringStorage && _ringStorage->pop(frame); }
+
+private:
+  std::atomic<bool> _enabled{ false };
+  bool _active = false;
+  Clock::time_point _blockStart;
+  Clock::time_point _stageStart;
+  TelemetryFrame _frame;
+  // Owned by the GUI thread and kept until destruction once allocated, so the
+  // audio thread's pointer never dangles
+  std::unique_ptr<Ring> _ringStorage;
+  std::atomic<Ring*> _ring{ nullptr };
+
+  static float micros(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<float, std::micro>(end - start).count();
+  }
+
+  void measureLevels(const ml::DSPVector& x, int channel) {
+    const float* p = x.getConstBuffer();
+    float peak = 0.0f, sumSquares = 0.0f;
+    for (size_t i = 0; i < ml::kFloatsPerDSPVector; ++i) {
+      peak = std::max(peak, std::fabs(p[i]));
+      sumSquares += p[i] * p[i];
+    }
+    _frame.peak[channel] = peak;
+    _frame.rms[channel] = std::sqrt(sumSquares / static_cast<float>(ml::kFloatsPerDSPVector));
+  }
+};
@@ -0,0 +1,181 @@
+#include "Trace.h"
+
+#ifdef ENABLE_TRACING
+
+#include "SpscRing.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace trace {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Events one thread can queue between two flushes
+constexpr size_t kRingCapacity = 1 << 14;
+constexpr auto kFlushInterval = std::chrono::milliseconds(100);
+
+struct ThreadBuffer {
+  SpscRing<Event, kRingCapacity> ring;
+  std::atomic<uint64_t> dropped{ 0 };
+  uint64_t threadId = 0;
+};
+
+class Tracer;
+std::atomic<Tracer*> gTracer{ nullptr };
+
+// Owns the per-thread rings and the writer thread. Created on the first event and
+// never destroyed, so no thread's ring pointer can dangle; stop() ends the writer.
+class Tracer {
+public:
+  static Tracer& get() {
+    static Tracer* tracer = [] {
+      auto* created = new Tracer;
+      gTracer.store(created, std::memory_order_release);
+      return created;
+    }();
+    return *tracer;
+  }
+
+  const Clock::time_point epoch = Clock::now();
+
+  bool isStopped() const { return _stopped.load(std::memory_order_relaxed); }
+
+  // Final flush, then closes the file. Safe to call more than once.
+  void stop() {
+    std::lock_guard<std::mutex> stopLock(_stopMutex);
+    if (isStopped()) return;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_one();
+    _writer.join();
+    _stopped.store(true, std::memory_order_relaxed);
+    if (_file) {
+      std::fputs("\n]\n", _file);
+      std::fclose(_file);
+      _file = nullptr;
+    }
+  }
+
+  ThreadBuffer* registerThread() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _buffers.push_back(std::make_unique<ThreadBuffer>());
+    _buffers.back()->threadId = _buffers.size();
+    return _buffers.back().get();
+  }
+
+private:
+  std::mutex _mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+  std::condition_variable _wake;
+  bool _stop = false;
+  std::mutex _stopMutex;
+  std::atomic<bool> _stopped{ false };
+  std::thread _writer;
+  FILE* _file = nullptr;
+  bool _firstEvent = true;
+  int _pid = static_cast<int>(getpid());
+
+  Tracer() {
+    std::string path;
+    if (const char* env = std::getenv("TRACE_FILE")) {
+      path = env;
+    } else {
+      std::error_code error;
+      auto dir = std::filesystem::temp_directory_path(error);
+      path = (dir / ("TanhSaturator-trace-" + std::to_string(_pid) + ".json")).string();
+    }
+    _file = std::fopen(path.c_str(), "w");
+    if (_file) std::fputs("[\n", _file);
+    _writer = std::thread([this] { run(); });
+  }
+
+  void run() {
+    std::vector<ThreadBuffer*> buffers;
+    bool stop = false;
+    while (!stop) {
+      // Registration only appends and never frees, so the rings can be drained
+      // without the lock once the list is copied
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wake.wait_for(lock, kFlushInterval, [this] { return _stop; });
+        stop = _stop;
+        buffers.clear();
+        for (auto& buffer : _buffers) buffers.push_back(buffer.get());
+      }
+      flush(buffers);
+    }
+    writeDropped(buffers);
+  }
+
+  void flush(const std::vector<ThreadBuffer*>& buffers) {
+    if (!_file) return;
+    Event event;
+    for (ThreadBuffer* buffer : buffers) {
+      while (buffer->ring.pop(event)) {
+        std::fprintf(_file,
+                     "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f,"
+                     "\"args\":{\"instance\":\"%p\"}}",
+                     _firstEvent ? "" : ",\n", event.name, _pid, static_cast<unsigned long long>(buffer->threadId),
+                     event.startNanos * 1e-3, event.durationNanos * 1e-3, event.id);
+        _firstEvent = false;
+      }
+    }
+    std::fflush(_file);
+  }
+
+  // Reports events lost to full rings as metadata on each thread
+  void writeDropped(const std::vector<ThreadBuffer*>& buffers) {
+    if (!_file) return;
+    for (ThreadBuffer* buffer : buffers) {
+      const uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+      if (dropped == 0) continue;
+      std::fprintf(_file, "%s{\"name\":\"dropped_events\",\"ph\":\"M\",\"pid\":%d,\"tid\":%llu,\"args\":{\"count\":%llu}}",
+                   _firstEvent ? "" : ",\n", _pid, static_cast<unsigned long long>(buffer->threadId),
+                   static_cast<unsigned long long>(dropped));
+      _firstEvent = false;
+    }
+  }
+};
+
+} // namespace
+
+uint64_t nowNanos() {
+  static const Clock::time_point epoch = Tracer::get().epoch;
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+}
+
+void record(const Event& event) {
+  thread_local ThreadBuffer* buffer = Tracer::get().registerThread();
+  if (Tracer::get().isStopped()) return;
+  if (!buffer->ring.push(event)) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void shutdown() {
+  if (Tracer* tracer = gTracer.load(std::memory_order_acquire)) tracer->stop();
+}
+
+} // namespace trace
+
+#endif
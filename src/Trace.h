@@ -0,0 +1,73 @@
+#pragma once
+
+// Scoped trace markers for finding where time goes across threads and instances.
+//
+// Built only with -DENABLE_TRACING=ON; otherwise TRACE_SCOPE expands to nothing.
+// When enabled, each scope records one complete event (name, instance, start,
+// duration) into a wait-free ring owned by the calling thread. A background
+// thread drains every ring and appends the events to a Chrome-trace JSON file,
+// which chrome://tracing and ui.perfetto.dev open directly. The file is
+// $TRACE_FILE, or TanhSaturator-trace-<pid>.json in the temp directory.
+//
+// A thread's first event registers its ring, which allocates and locks once.
+// After that, recording is two clock reads and a ring push; when the ring is
+// full, events are dropped and counted rather than waiting for the writer.
+//
+// shutdown() stops the writer and completes the file. Call it from an explicit
+// teardown point, such as the CLAP entry's deinit or the end of main(); nothing
+// is done from static destructors, which run under the loader lock on Windows.
+// The rings are never freed, so threads that still record afterwards are safe.
+
+#ifdef ENABLE_TRACING
+
+#include <cstdint>
+
+namespace trace {
+
+struct Event {
+  const char* name = nullptr;  // string literal
+  const void* id = nullptr;    // instance the event belongs to, or null
+  uint64_t startNanos = 0;
+  uint64_t durationNanos = 0;
+};
+
+// Nanoseconds since the tracer started
+uint64_t nowNanos();
+
+// Queues an event on the calling thread's ring
+void record(const Event& event);
+
+// Stops the writer thread after a final flush and closes the file. Later events
+// are dropped. Does nothing if no event was ever recorded.
+void shutdown();
+
+class Scope {
+public:
+  Scope(const char* name, const void* id) : _name(name), _id(id), _start(nowNanos()) {}
+  ~Scope() { record(Event{ _name, _id, _start, nowNanos() - _start }); }
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  const char* _name;
+  const void* _id;
+  uint64_t _start;
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing block as event "name" of instance id
+#define TRACE_SCOPE(name, id) ::trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name, id)
+
+#else
+
+#define TRACE_SCOPE(name, id) ((void)0)
+
+namespace trace {
+inline void shutdown() {}
+} // namespace trace
+
+#endif
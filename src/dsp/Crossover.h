@@ -0,0 +1,245 @@
+#pragma once
+
+#include "MLDSPOps.h"
+#include "Svf.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace dsp {
+
+// Largest number of bands a Crossover splits into
+constexpr int kMaxBands = 4;
+
+// Linkwitz-Riley crossover (24 dB/octave) splitting CHANNELS channels, packed
+// into one DSPVectorArray, into up to kMaxBands bands.
+//
+// Each split is two cascaded second-order Butterworth sections, built from the
+// same trapezoidal SVF as SvfLowpass. The first section is shared by the low and
+// high outputs, so a split costs three sections. The two outputs are in phase
+// and sum to a second-order allpass. Bands below a later split pass through the
+// matching allpass, so all bands sum back to the input with a flat magnitude
+// response and no dips at the crossover frequencies. All sections of one split
+// run in the same loop, so their recursions overlap in the pipeline. Automated
+// split frequencies ramp per sample through the shared SvfCoeffTable, as the
+// lowpass cutoff does.
+//
+// The bands are written band-major into a pack of CHANNELS * BANDS rows, so the
+// saturator processes every band of every channel in one pass.
+template <size_t CHANNELS>
+class Crossover {
+public:
+  using Pack = ml::DSPVectorArray<CHANNELS>;
+
+  // Row of one channel of one band in the output of process()
+  static constexpr int row(int band, size_t channel) {
+    return band * static_cast<int>(CHANNELS) + static_cast<int>(channel);
+  }
+
+  // nBands from 1 to kMaxBands, with nBands - 1 ascending split frequencies in Hz.
+  // The splits ramp to the new frequencies over rampSamples samples through the
+  // table's log-frequency grid, looking up g per sample as SvfLowpass does. A new
+  // band count, a different table or the first call after reset() jumps instead;
+  // a new band count also clears the filter state. The table must stay alive
+  // until the next setBands() or reset().
+  void setBands(int nBands, const SvfCoeffTable& table, const float* hz, int rampSamples) {
+    const bool jump = setBandCount(nBands) || _table != &table || rampSamples <= 0;
+    _table = &table;
+    _remaining = jump ? 0 : rampSamples;
+    for (int s = 0; s < _nBands - 1; ++s) {
+      _targetPositions[s] = table.locate(hz[s], kButterworthQ);
+      if (jump) {
+        _positions[s] = _targetPositions[s];
+        _coeffs[s] = SvfCoeffs::fromG(table.lookupG(_positions[s].freq), kButterworthK);
+      } else {
+        _dFreq[s] = (_targetPositions[s].freq - _positions[s].freq) / static_cast<float>(rampSamples);
+      }
+    }
+  }
+
+  // As above with split frequencies given as fractions of the sample rate, for
+  // rates without a table. The new coefficients apply from the next process().
+  void setBands(int nBands, const float* omegas) {
+    setBandCount(nBands);
+    _table = nullptr;
+    _remaining = 0;
+    for (int s = 0; s < _nBands - 1; ++s) {
+      _coeffs[s] = SvfCoeffs::make(omegas[s], kButterworthK);
+    }
+  }
+
+  int getBands() const { return _nBands; }
+
+  bool isRamping() const { return _remaining > 0; }
+
+  void reset() {
+    clearState();
+    _table = nullptr;
+    _remaining = 0;
+  }
+
+  // Zero the filters but keep the coefficients and any ramp in progress
+  void clearState() {
+    for (auto& split : _splits) split = Split();
+  }
+
+  // Largest integrator state over all sections and channels, as SvfLowpass::getStateMagnitude()
+  float getStateMagnitude() const {
+    float m = 0.0f;
+    for (const auto& split : _splits) {
+      for (const auto& section : split.sections) {
+        for (size_t c = 0; c < CHANNELS; ++c) {
+          m = std::max(m, std::fabs(section.ic1eq[c]) + std::fabs(section.ic2eq[c]));
+        }
+      }
+    }
+    return m;
+  }
+
+  // Splits input into getBands() bands, which must not be more than BANDS.
+  // Rows of bands beyond getBands() are silent.
+  template <int BANDS>
+  void process(const Pack& input, ml::DSPVectorArray<CHANNELS * BANDS>& bands) {
+    static_assert(BANDS <= kMaxBands, "too many bands");
+    constexpr size_t kRows = CHANNELS * ml::kFloatsPerDSPVector;
+    const int nBands = std::min(_nBands, BANDS);
+    float* out = bands.getBuffer();
+
+    // The part of the signal above every split so far, starting with all of it
+    Pack rest = input;
+    float* restBuffer = rest.getBuffer();
+
+    // Band s is the low output of split s; the high output carries on to the next
+    // split. The bands below s go through the allpass of split s. During a ramp the
+    // coefficients of each split are computed per sample first, as SvfLowpass does.
+    // Only g comes from the table: k stays exactly Butterworth, since interpolating
+    // it between Q grid points would leave ripple in the summed response.
+    const int rampLength = (_remaining > 0 && _table) ? std::min(_remaining, static_cast<int>(ml::kFloatsPerDSPVector)) : 0;
+    SvfCoeffs ramp[ml::kFloatsPerDSPVector];
+    for (int s = 0; s < nBands - 1; ++s) {
+      if (rampLength > 0) {
+        SvfCoeffTable::Position position = _positions[s];
+        for (int j = 0; j < rampLength; ++j) {
+          position.freq += _dFreq[s];
+          ramp[j] = SvfCoeffs::fromG(_table->lookupG(position.freq), kButterworthK);
+        }
+        const bool done = rampLength == _remaining;
+        _positions[s] = done ? _targetPositions[s] : position;
+        _coeffs[s] = SvfCoeffs::fromG(_table->lookupG(_positions[s].freq), kButterworthK);
+      }
+      switch (s) {
+        case 0: split<0>(ramp, rampLength, _coeffs[s], _splits[s], restBuffer, out); break;
+        case 1: split<1>(ramp, rampLength, _coeffs[s], _splits[s], restBuffer, out); break;
+        default: split<2>(ramp, rampLength, _coeffs[s], _splits[s], restBuffer, out); break;
+      }
+    }
+    _remaining -= rampLength;
+
+    // The last band is everything above the highest split
+    std::copy(restBuffer, restBuffer + kRows, out + (nBands - 1) * kRows);
+    std::fill(out + nBands * kRows, out + BANDS * kRows, 0.0f);
+  }
+
+private:
+  // k = 1 / Q with Q = 1 / sqrt(2)
+  static constexpr float kButterworthK = 1.41421356f;
+  static constexpr float kButterworthQ = 0.70710678f;
+
+  // Integrator states of one SVF section, one per channel
+  struct Section {
+    float ic1eq[CHANNELS] = {};
+    float ic2eq[CHANNELS] = {};
+  };
+
+  // Sections of one split: the shared first section, the second sections of the
+  // low and high outputs, and an allpass for each band below the split
+  struct Split {
+    static constexpr int kShared = 0, kLow = 1, kHigh = 2, kAllpass = 3;
+    std::array<Section, kAllpass + kMaxBands - 2> sections;
+  };
+
+  int _nBands = 1;
+  std::array<SvfCoeffs, kMaxBands - 1> _coeffs;
+  std::array<Split, kMaxBands - 1> _splits;
+
+  // Table the coefficients came from, or null, and the ramp of every split through it
+  const SvfCoeffTable* _table = nullptr;
+  std::array<SvfCoeffTable::Position, kMaxBands - 1> _positions;
+  std::array<SvfCoeffTable::Position, kMaxBands - 1> _targetPositions;
+  std::array<float, kMaxBands - 1> _dFreq{};
+  int _remaining = 0;
+
+  // Returns true if the band count changed, which clears the filter state
+  bool setBandCount(int nBands) {
+    nBands = std::max(1, std::min(nBands, kMaxBands));
+    if (nBands == _nBands) return false;
+    _nBands = nBands;
+    clearState();
+    return true;
+  }
+
+  // One sample of one section. Returns the lowpass output and sets v1, from which
+  // the highpass and allpass outputs are derived.
+  static inline float tick(const SvfCoeffs& c, float& s1, float& s2, float x, float& v1) {
+    float v3 = x - s2;
+    v1 = c.a1 * s1 + c.a2 * v3;
+    float v2 = s2 + c.a2 * s1 + c.a3 * v3;
+    s1 = 2.0f * v1 - s1;
+    s2 = 2.0f * v2 - s2;
+    return v2;
+  }
+
+  // Split number LOWER: writes band LOWER from rest, replaces rest with its high
+  // output and passes the LOWER bands below through the allpass. The first
+  // rampLength samples use the coefficients in ramp, the rest c.
+  template <int LOWER>
+  static void split(const SvfCoeffs* ramp, int rampLength, const SvfCoeffs& c, Split& split, float* rest, float* bands) {
+    constexpr int kSize = static_cast<int>(ml::kFloatsPerDSPVector);
+    constexpr int kSections = Split::kAllpass + LOWER;
+    constexpr size_t kRows = CHANNELS * ml::kFloatsPerDSPVector;
+
+    // Local copies of the state, as SvfLowpass::process()
+    float s1[kSections][CHANNELS], s2[kSections][CHANNELS];
+    for (int n = 0; n < kSections; ++n) {
+      std::copy(std::begin(split.sections[n].ic1eq), std::end(split.sections[n].ic1eq), s1[n]);
+      std::copy(std::begin(split.sections[n].ic2eq), std::end(split.sections[n].ic2eq), s2[n]);
+    }
+
+    float* band = bands + LOWER * kRows;
+    auto step = [&](const SvfCoeffs& ci, int i) {
+      for (size_t ch = 0; ch < CHANNELS; ++ch) {
+        const size_t j = ch * ml::kFloatsPerDSPVector + i;
+        float v1;
+
+        // Shared first section
+        const float x = rest[j];
+        const float low1 = tick(ci, s1[Split::kShared][ch], s2[Split::kShared][ch], x, v1);
+        const float high1 = x - ci.k * v1 - low1;
+
+        // Second sections
+        band[j] = tick(ci, s1[Split::kLow][ch], s2[Split::kLow][ch], low1, v1);
+        const float low2 = tick(ci, s1[Split::kHigh][ch], s2[Split::kHigh][ch], high1, v1);
+        rest[j] = high1 - ci.k * v1 - low2;
+
+        // Allpasses on the bands below
+        for (int b = 0; b < LOWER; ++b) {
+          float& y = bands[b * kRows + j];
+          tick(ci, s1[Split::kAllpass + b][ch], s2[Split::kAllpass + b][ch], y, v1);
+          y -= 2.0f * ci.k * v1;
+        }
+      }
+    };
+
+    // Ramp section, then static section
+    int i = 0;
+    for (; i < rampLength; ++i) step(ramp[i], i);
+    for (; i < kSize; ++i) step(c, i);
+
+    for (int n = 0; n < kSections; ++n) {
+      std::copy(s1[n], s1[n] + CHANNELS, split.sections[n].ic1eq);
+      std::copy(s2[n], s2[n] + CHANNELS, split.sections[n].ic2eq);
+    }
+  }
+};
+
+} // namespace dsp
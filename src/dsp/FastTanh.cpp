@@ -0,0 +1,17 @@
+#include "FastTanh.h"
+
+namespace dsp {
+
+TanhTable::TanhTable() {
+  for (int i = 0; i <= kSize; ++i) {
+    double x = -static_cast<double>(kRange) + i / static_cast<double>(kScale);
+    values[i] = static_cast<float>(std::tanh(x));
+  }
+}
+
+const TanhTable& TanhTable::get() {
+  static const TanhTable table;
+  return table;
+}
+
+} // namespace dsp
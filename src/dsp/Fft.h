@@ -0,0 +1,66 @@
+#pragma once
+
+#include "SharedResource.h"
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace dsp {
+
+// In-place iterative radix-2 complex FFT for display and analysis work off the
+// audio thread. The twiddle and bit-reversal tables depend only on the size and
+// are shared by all Fft objects of that size in the process.
+class Fft {
+public:
+  explicit Fft(int size) : _size(size), _tables(SharedResource<Tables>::acquire(size, [size]() { return new Tables(size); })) {}
+
+  int getSize() const { return _size; }
+
+  // Forward transform of getSize() values
+  void forward(std::complex<float>* data) const {
+    const auto& bitReverse = _tables->bitReverse;
+    const auto& twiddles = _tables->twiddles;
+    for (int i = 0; i < _size; ++i) {
+      if (i < bitReverse[i]) std::swap(data[i], data[bitReverse[i]]);
+    }
+    for (int half = 1; half < _size; half *= 2) {
+      const int stride = _size / (2 * half);
+      for (int start = 0; start < _size; start += 2 * half) {
+        for (int k = 0; k < half; ++k) {
+          std::complex<float> t = twiddles[k * stride] * data[start + k + half];
+          data[start + k + half] = data[start + k] - t;
+          data[start + k] += t;
+        }
+      }
+    }
+  }
+
+private:
+  struct Tables {
+    std::vector<std::complex<float>> twiddles;
+    std::vector<int> bitReverse;
+
+    explicit Tables(int size) : twiddles(size / 2), bitReverse(size) {
+      int bits = 0;
+      while ((1 << bits) < size) ++bits;
+      for (int i = 0; i < size; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+          r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[i] = r;
+      }
+      for (int i = 0; i < size / 2; ++i) {
+        double phase = -2.0 * 3.14159265358979323846 * i / size;
+        twiddles[i] = std::complex<float>(static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase)));
+      }
+    }
+  };
+
+  int _size;
+  std::shared_ptr<const Tables> _tables;
+};
+
+} // namespace dsp
@@ -0,0 +1,360 @@
+#include "Oversampler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace dsp {
+
+namespace {
+
+// Per-stage designs. Later stages see a signal already band-limited by the
+// stages before them, so they get away with wider transition bands.
+constexpr int kFirHalfOrders[Oversampler<1>::kMaxFactorLog2] = { 12, 6, 4 };
+constexpr float kFirKaiserBetas[Oversampler<1>::kMaxFactorLog2] = { 8.0f, 7.0f, 6.0f };
+constexpr int kAllpassCoeffCounts[Oversampler<1>::kMaxFactorLog2] = { 8, 4, 3 };
+constexpr double kAllpassTransitions[Oversampler<1>::kMaxFactorLog2] = { 0.04, 0.16, 0.28 };
+
+static_assert(OversamplerDesigns::kStages == Oversampler<1>::kMaxFactorLog2, "one design per stage");
+
+constexpr double kPiD = 3.14159265358979323846;
+
+// Zeroth-order modified Bessel function of the first kind, for the Kaiser window.
+double besselI0(double x) {
+  double sum = 1.0, term = 1.0;
+  for (int k = 1; k < 50; ++k) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < 1e-12 * sum) break;
+  }
+  return sum;
+}
+
+// Elliptic-function design of polyphase allpass halfband coefficients.
+// Follows Valenzuela & Constantinides, as popularised by Laurent de Soras' HIIR.
+double allpassAccNum(double q, int order, int c) {
+  double acc = 0.0, term;
+  int i = 0, sign = 1;
+  do {
+    term = std::pow(q, i * (i + 1)) * std::sin((i * 2 + 1) * c * kPiD / order) * sign;
+    acc += term;
+    sign = -sign;
+    ++i;
+  } while (std::fabs(term) > 1e-100);
+  return acc;
+}
+
+double allpassAccDen(double q, int order, int c) {
+  double acc = 0.0, term;
+  int i = 1, sign = -1;
+  do {
+    term = std::pow(q, i * i) * std::cos(i * 2 * c * kPiD / order) * sign;
+    acc += term;
+    sign = -sign;
+    ++i;
+  } while (std::fabs(term) > 1e-100);
+  return acc;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// HalfbandFir
+
+void HalfbandFir::design(int halfOrder, float kaiserBeta) {
+  _halfOrder = std::min(halfOrder, kMaxHalfOrder);
+  halfOrder = _halfOrder;
+  const int length = 4 * halfOrder + 1;
+  const int center = 2 * halfOrder;
+  const double windowNorm = besselI0(kaiserBeta);
+
+  _oddTaps.fill(0.0f);
+  double sum = 0.0;
+  for (int k = 0; k < 2 * halfOrder; ++k) {
+    int j = 2 * k + 1;
+    double t = (j - center) * 0.5;
+    double sinc = std::sin(kPiD * t) / (kPiD * t);
+    double r = (2.0 * j) / (length - 1) - 1.0;
+    double window = besselI0(kaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / windowNorm;
+    double tap = 0.5 * sinc * window;
+    _oddTaps[k] = static_cast<float>(tap);
+    sum += tap;
+  }
+
+  // Scale the odd branch to sum to 0.5 so the DC gain is exactly one.
+  for (int k = 0; k < 2 * halfOrder; ++k) {
+    _oddTaps[k] = static_cast<float>(_oddTaps[k] * (0.5 / sum));
+  }
+}
+
+// Both directions accumulate one tap at a time across every output sample of
+// the block. Each pass over the block is an independent multiply-add per sample,
+// which the compiler vectorizes; a per-sample sum over the taps is a float
+// reduction, which it can't reorder into SIMD without fast-math. The taps are
+// still added in the same order for every output.
+
+void HalfbandFir::upsample(float* buf, const float* input, float* output, int n) const {
+  const int history = 2 * _halfOrder;
+  const int nTaps = 2 * _halfOrder;
+  std::copy(input, input + n, buf + history);
+
+  std::array<float, kMaxBlockSize> acc;
+  const float* x = buf + history;
+  std::fill(acc.begin(), acc.begin() + n, 0.0f);
+  for (int k = 0; k < nTaps; ++k) {
+    const float tap = _oddTaps[k];
+    const float* xk = x - k;
+    for (int i = 0; i < n; ++i) acc[i] += tap * xk[i];
+  }
+
+  for (int i = 0; i < n; ++i) {
+    output[2 * i] = x[i - _halfOrder];
+    output[2 * i + 1] = 2.0f * acc[i];
+  }
+
+  std::copy(buf + n, buf + n + history, buf);
+}
+
+void HalfbandFir::downsample(float* buf, const float* input, float* output, int n) const {
+  const int history = 4 * _halfOrder;
+  const int nTaps = 2 * _halfOrder;
+  std::copy(input, input + 2 * n, buf + history);
+
+  // The odd branch, deinterleaved so each tap reads consecutive samples:
+  // odd[j + nTaps] = u[2j - 1], with u the high-rate input, history included
+  const float* u = buf + history;
+  std::array<float, kMaxBlockSize + 2 * kMaxHalfOrder> odd;
+  for (int j = 1 - nTaps; j < n; ++j) odd[j + nTaps] = u[2 * j - 1];
+
+  // The even branch is a pure delay
+  std::array<float, kMaxBlockSize> acc;
+  for (int i = 0; i < n; ++i) acc[i] = 0.5f * u[2 * (i - _halfOrder)];
+  for (int k = 0; k < nTaps; ++k) {
+    const float tap = _oddTaps[k];
+    const float* uk = odd.data() + nTaps - k;
+    for (int i = 0; i < n; ++i) acc[i] += tap * uk[i];
+  }
+  std::copy(acc.begin(), acc.begin() + n, output);
+
+  std::copy(buf + 2 * n, buf + 2 * n + history, buf);
+}
+
+// ---------------------------------------------------------------------------
+// HalfbandAllpass
+
+void HalfbandAllpass::design(int nCoeffs, double transitionBandwidth) {
+  _nCoeffs = std::min(nCoeffs, kMaxCoeffs);
+
+  double k = std::tan((1.0 - transitionBandwidth * 2.0) * kPiD / 4.0);
+  k *= k;
+  const double kksqrt = std::pow(1.0 - k * k, 0.25);
+  const double e = 0.5 * (1.0 - kksqrt) / (1.0 + kksqrt);
+  const double e4 = e * e * e * e;
+  const double q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+
+  const int order = _nCoeffs * 2 + 1;
+  _latency = 0.5f;
+  for (int i = 0; i < _nCoeffs; ++i) {
+    const int c = i + 1;
+    const double num = allpassAccNum(q, order, c) * std::pow(q, 0.25);
+    const double den = allpassAccDen(q, order, c) + 0.5;
+    const double ww = num / den;
+    const double wwsq = ww * ww;
+    const double x = std::sqrt((1.0 - wwsq * k) * (1.0 - wwsq / k)) / (1.0 + wwsq);
+    const double coeff = (1.0 - x) / (1.0 + x);
+    _coeffs[i] = static_cast<float>(coeff);
+
+    // DC group delay of a first-order allpass is (1 - a) / (1 + a)
+    _latency += static_cast<float>((1.0 - coeff) / (1.0 + coeff));
+  }
+
+  reset();
+}
+
+void HalfbandAllpass::reset() {
+  std::fill(std::begin(_up.x1), std::end(_up.x1), 0.0f);
+  std::fill(std::begin(_up.y1), std::end(_up.y1), 0.0f);
+  std::fill(std::begin(_down.x1), std::end(_down.x1), 0.0f);
+  std::fill(std::begin(_down.y1), std::end(_down.y1), 0.0f);
+}
+
+void HalfbandAllpass::upsample(const float* input, float* output, int n) {
+  for (int i = 0; i < n; ++i) {
+    output[2 * i] = processChain(_up, _coeffs, 0, _nCoeffs, input[i]);
+    output[2 * i + 1] = processChain(_up, _coeffs, 1, _nCoeffs, input[i]);
+  }
+}
+
+void HalfbandAllpass::downsample(const float* input, float* output, int n) {
+  for (int i = 0; i < n; ++i) {
+    float even = processChain(_down, _coeffs, 0, _nCoeffs, input[2 * i + 1]);
+    float odd = processChain(_down, _coeffs, 1, _nCoeffs, input[2 * i]);
+    output[i] = 0.5f * (even + odd);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// OversamplerDesigns
+
+OversamplerDesigns::OversamplerDesigns() {
+  for (int s = 0; s < kStages; ++s) {
+    const int maxInputSize = static_cast<int>(ml::kFloatsPerDSPVector) << s;
+    fir[s].design(kFirHalfOrders[s], kFirKaiserBetas[s]);
+    allpass[s].design(kAllpassCoeffCounts[s], kAllpassTransitions[s]);
+
+    upHistoryOffset[s] = historyPerChannel;
+    historyPerChannel += fir[s].upHistorySize(maxInputSize);
+    downHistoryOffset[s] = historyPerChannel;
+    historyPerChannel += fir[s].downHistorySize(maxInputSize);
+  }
+}
+
+const OversamplerDesigns& OversamplerDesigns::get() {
+  static const OversamplerDesigns designs;
+  return designs;
+}
+
+// ---------------------------------------------------------------------------
+// Oversampler
+
+template <size_t CHANNELS>
+Oversampler<CHANNELS>::Oversampler()
+    : _designs(&OversamplerDesigns::get()),
+      _firHistory(CHANNELS * _designs->historyPerChannel, 0.0f) {
+  for (auto& stages : _allpassStages) {
+    for (int s = 0; s < kMaxFactorLog2; ++s) stages[s] = _designs->allpass[s];
+  }
+}
+
+template <size_t CHANNELS>
+void Oversampler<CHANNELS>::setFactor(int factorLog2) {
+  factorLog2 = std::max(0, std::min(factorLog2, kMaxFactorLog2));
+  if (factorLog2 != _factorLog2) {
+    _factorLog2 = factorLog2;
+    reset();
+  }
+}
+
+template <size_t CHANNELS>
+void Oversampler<CHANNELS>::setMode(OversamplingMode mode) {
+  if (mode != _mode) {
+    _mode = mode;
+    reset();
+  }
+}
+
+template <size_t CHANNELS>
+void Oversampler<CHANNELS>::reset() {
+  std::fill(_firHistory.begin(), _firHistory.end(), 0.0f);
+  for (auto& stages : _allpassStages) {
+    for (auto& stage : stages) stage.reset();
+  }
+}
+
+template <size_t CHANNELS>
+void Oversampler<CHANNELS>::upsampleStage(size_t channel, int stage, const float* input, float* output, int n) {
+  if (_mode == OversamplingMode::kLinearPhase) {
+    float* history = _firHistory.data() + channel * _designs->historyPerChannel + _designs->upHistoryOffset[stage];
+    _designs->fir[stage].upsample(history, input, output, n);
+  } else {
+    _allpassStages[channel][stage].upsample(input, output, n);
+  }
+}
+
+template <size_t CHANNELS>
+void Oversampler<CHANNELS>::downsampleStage(size_t channel, int stage, const float* input, float* output, int n) {
+  if (_mode == OversamplingMode::kLinearPhase) {
+    float* history = _firHistory.data() + channel * _designs->historyPerChannel + _designs->downHistoryOffset[stage];
+    _designs->fir[stage].downsample(history, input, output, n);
+  } else {
+    _allpassStages[channel][stage].downsample(input, output, n);
+  }
+}
+
+template <size_t CHANNELS>
+void Oversampler<CHANNELS>::upsample(const Pack& input) {
+  constexpr int kSize = static_cast<int>(ml::kFloatsPerDSPVector);
+  if (_factorLog2 == 0) {
+    pack(0) = input;
+    return;
+  }
+
+  const int lastStage = _factorLog2 - 1;
+  for (size_t c = 0; c < CHANNELS; ++c) {
+    // Ping-pong through the scratch buffers up to the last stage
+    const float* src = input.getConstBuffer() + c * kSize;
+    for (int s = 0; s < lastStage; ++s) {
+      float* dst = (s & 1) ? _scratchB.data() : _scratchA.data();
+      upsampleStage(c, s, src, dst, kSize << s);
+      src = dst;
+    }
+
+    // The last stage writes one DSPVector at a time into this channel's row of each pack
+    for (int r = 0; r < getFactor(); ++r) {
+      upsampleStage(c, lastStage, src + r * (kSize / 2), pack(r).row(static_cast<int>(c)).getBuffer(), kSize / 2);
+    }
+  }
+}
+
+template <size_t CHANNELS>
+void Oversampler<CHANNELS>::downsample(Pack& output) {
+  constexpr int kSize = static_cast<int>(ml::kFloatsPerDSPVector);
+  if (_factorLog2 == 0) {
+    output = pack(0);
+    return;
+  }
+
+  const int lastStage = _factorLog2 - 1;
+  for (size_t c = 0; c < CHANNELS; ++c) {
+    float* out = output.row(static_cast<int>(c)).getBuffer();
+
+    // The last stage reads one DSPVector at a time from this channel's row of each pack
+    float* dst = (lastStage == 0) ? out : ((lastStage & 1) ? _scratchB.data() : _scratchA.data());
+    for (int r = 0; r < getFactor(); ++r) {
+      downsampleStage(c, lastStage, pack(r).row(static_cast<int>(c)).getBuffer(), dst + r * (kSize / 2), kSize / 2);
+    }
+
+    // Ping-pong back down to the base rate
+    const float* src = dst;
+    for (int s = lastStage - 1; s >= 0; --s) {
+      dst = (s == 0) ? out : ((s & 1) ? _scratchB.data() : _scratchA.data());
+      downsampleStage(c, s, src, dst, kSize << s);
+      src = dst;
+    }
+  }
+}
+
+template <size_t CHANNELS>
+int Oversampler<CHANNELS>::getLatency() const {
+  return static_cast<int>(delayFor(_factorLog2, _mode) + 0.5f);
+}
+
+template <size_t CHANNELS>
+float Oversampler<CHANNELS>::delayFor(int factorLog2, OversamplingMode mode) {
+  const OversamplerDesigns& designs = OversamplerDesigns::get();
+  float delay = 0.0f;
+  for (int s = 0; s < std::min(factorLog2, kMaxFactorLog2); ++s) {
+    float stageLatency = (mode == OversamplingMode::kLinearPhase)
+      ? static_cast<float>(designs.fir[s].getLatency())
+      : designs.allpass[s].getLatency();
+    // Stage s runs at 2^s times the base rate
+    delay += stageLatency / static_cast<float>(1 << s);
+  }
+  return delay;
+}
+
+template <size_t CHANNELS>
+int Oversampler<CHANNELS>::costPerSample(int factorLog2, OversamplingMode mode) {
+  int cost = 0;
+  for (int s = 0; s < std::min(factorLog2, kMaxFactorLog2); ++s) {
+    int stageCost = (mode == OversamplingMode::kLinearPhase) ? 4 * kFirHalfOrders[s] : 2 * kAllpassCoeffCounts[s];
+    cost += stageCost << s;
+  }
+  return cost;
+}
+
+template class Oversampler<1>;
+template class Oversampler<2>;
+template class Oversampler<4>;
+template class Oversampler<8>;
+template class Oversampler<16>;
+
+} // namespace dsp
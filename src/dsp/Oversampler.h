@@ -0,0 +1,179 @@
+#pragma once
+
+#include "MLDSPOps.h"
+#include <array>
+#include <vector>
+
+// Polyphase halfband oversampling for the saturation stage.
+//
+// Factors of 2x, 4x and 8x are built from cascaded 2x stages. Each stage runs
+// only its non-trivial polyphase branch, so the cost per stage is half of a
+// direct-form filter of the same length.
+//
+// Two filter families are available:
+//   kLinearPhase    Kaiser-windowed sinc halfband FIRs. Constant group delay,
+//                   reported to the host as latency.
+//   kMinimumPhase   Polyphase IIR allpass halfbands (Valenzuela/Constantinides).
+//                   Much cheaper and nearly zero latency, with phase distortion
+//                   near the band edge.
+//
+// Multiply-adds per base-rate sample for one channel (up + down, excluding the
+// saturator itself) and latency in base-rate samples. See costPerSample().
+//
+//   factor   linear phase       minimum phase
+//     2x      48   24 samples    16   ~4 samples
+//     4x      96   30 samples    32   ~5 samples
+//     8x     160   32 samples    56   ~5 samples
+namespace dsp {
+
+enum class OversamplingMode { kLinearPhase = 0, kMinimumPhase };
+
+// One 2x linear-phase halfband stage. The FIR has 4m+1 taps; the even branch
+// reduces to a pure delay, so only the 2m odd taps are evaluated.
+// The stage holds only its design; the caller owns the history buffers, so
+// one design serves every channel of every Oversampler.
+class HalfbandFir {
+public:
+  static constexpr int kMaxHalfOrder = 12;
+  // Largest block, in low-rate samples, for upsample() and downsample()
+  static constexpr int kMaxBlockSize = 4 * static_cast<int>(ml::kFloatsPerDSPVector);
+
+  // halfOrder = m, at most kMaxHalfOrder
+  void design(int halfOrder, float kaiserBeta);
+
+  // History floats needed for blocks of up to maxInputSize low-rate samples
+  int upHistorySize(int maxInputSize) const { return 2 * _halfOrder + maxInputSize; }
+  int downHistorySize(int maxInputSize) const { return 4 * _halfOrder + 2 * maxInputSize; }
+
+  // n low-rate samples in, 2n high-rate samples out
+  void upsample(float* history, const float* input, float* output, int n) const;
+  // 2n high-rate samples in, n low-rate samples out
+  void downsample(float* history, const float* input, float* output, int n) const;
+
+  // Delay of an up + down pair in low-rate samples
+  int getLatency() const { return 2 * _halfOrder; }
+
+private:
+  int _halfOrder = 0;
+  std::array<float, 2 * kMaxHalfOrder> _oddTaps{};  // 2m taps, h[1], h[3], ... h[4m-1]
+};
+
+// One 2x minimum-phase stage made of two parallel chains of first-order allpasses.
+class HalfbandAllpass {
+public:
+  static constexpr int kMaxCoeffs = 12;
+
+  // nCoeffs allpass coefficients for a normalized transition bandwidth (0 - 0.5)
+  void design(int nCoeffs, double transitionBandwidth);
+  void reset();
+
+  void upsample(const float* input, float* output, int n);
+  void downsample(const float* input, float* output, int n);
+
+  // Low-frequency group delay of an up + down pair in low-rate samples
+  float getLatency() const { return _latency; }
+
+private:
+  struct AllpassChain {
+    float x1[kMaxCoeffs];
+    float y1[kMaxCoeffs];
+  };
+
+  int _nCoeffs = 0;
+  float _coeffs[kMaxCoeffs] = {};
+  float _latency = 0.0f;
+  AllpassChain _up;
+  AllpassChain _down;
+
+  static inline float processChain(AllpassChain& chain, const float* coeffs, int first, int nCoeffs, float x) {
+    for (int i = first; i < nCoeffs; i += 2) {
+      float y = coeffs[i] * (x - chain.y1[i]) + chain.x1[i];
+      chain.x1[i] = x;
+      chain.y1[i] = y;
+      x = y;
+    }
+    return x;
+  }
+};
+
+// Filter designs for every stage, computed on first use and shared by every
+// Oversampler in the process, with the layout of one channel's FIR histories.
+struct OversamplerDesigns {
+  static constexpr int kStages = 3;
+
+  std::array<HalfbandFir, kStages> fir;
+  std::array<HalfbandAllpass, kStages> allpass;
+
+  // Offsets of stage s's up and down histories within one channel's block
+  std::array<int, kStages> upHistoryOffset;
+  std::array<int, kStages> downHistoryOffset;
+  int historyPerChannel = 0;
+
+  OversamplerDesigns();
+  static const OversamplerDesigns& get();
+};
+
+// Up/down-samples CHANNELS channels by 2^factorLog2 around a DSPVector-rate process.
+// The high-rate signal is stored as getFactor() consecutive packs, each holding
+// one DSPVector per channel, so the saturator runs on packed channels at the high rate too.
+// Construction copies the shared designs and makes one allocation for the FIR
+// histories of every channel and stage; nothing allocates afterwards.
+template <size_t CHANNELS>
+class Oversampler {
+public:
+  static constexpr int kMaxFactorLog2 = 3;
+  static constexpr int kMaxFactor = 1 << kMaxFactorLog2;
+
+  using Pack = ml::DSPVectorArray<CHANNELS>;
+
+  Oversampler();
+
+  // Changing factor or mode clears the filter state.
+  void setFactor(int factorLog2);
+  void setMode(OversamplingMode mode);
+  int getFactor() const { return 1 << _factorLog2; }
+  int getFactorLog2() const { return _factorLog2; }
+  OversamplingMode getMode() const { return _mode; }
+  void reset();
+
+  // Upsample one base-rate pack into packs 0 to getFactor() - 1.
+  void upsample(const Pack& input);
+
+  // High-rate pack r, in time order
+  Pack& pack(int r) {
+    return *reinterpret_cast<Pack*>(_highRate.getBuffer() + r * CHANNELS * ml::kFloatsPerDSPVector);
+  }
+
+  // Downsample the high-rate packs back to one base-rate pack.
+  void downsample(Pack& output);
+
+  // Latency in base-rate samples added by the current factor and mode.
+  int getLatency() const;
+
+  // Delay in base-rate samples added by a factor and mode, fractional for minimum phase
+  static float delayFor(int factorLog2, OversamplingMode mode);
+
+  // Multiply-adds per base-rate sample for one channel, excluding the saturator.
+  static int costPerSample(int factorLog2, OversamplingMode mode);
+
+private:
+  int _factorLog2 = 0;
+  OversamplingMode _mode = OversamplingMode::kLinearPhase;
+
+  // Stage i converts between rates 2^i and 2^(i+1). The FIR designs are shared;
+  // the allpass stages carry their own state and get a copy of theirs.
+  const OversamplerDesigns* _designs;
+  std::array<std::array<HalfbandAllpass, kMaxFactorLog2>, CHANNELS> _allpassStages;
+
+  // FIR histories, historyPerChannel floats per channel
+  std::vector<float> _firHistory;
+
+  ml::DSPVectorArray<kMaxFactor * CHANNELS> _highRate;
+  std::array<float, ml::kFloatsPerDSPVector * kMaxFactor> _scratchA;
+  std::array<float, ml::kFloatsPerDSPVector * kMaxFactor> _scratchB;
+
+  void upsampleStage(size_t channel, int stage, const float* input, float* output, int n);
+  void downsampleStage(size_t channel, int stage, const float* input, float* output, int n);
+};
+
+} // namespace dsp
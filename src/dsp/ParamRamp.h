@@ -0,0 +1,63 @@
+#pragma once
+
+#include "MLDSPOps.h"
+#include <algorithm>
+
+namespace dsp {
+
+// Linear parameter ramp for gains. A new target starts a ramp of fixed length;
+// each call to next() returns the per-sample values for one DSPVector.
+// The first target set after construction or reset() is applied immediately.
+class LinearRamp {
+public:
+  void setRampSamples(int samples) { _rampSamples = std::max(1, samples); }
+
+  void setTarget(float target) {
+    if (!_initialized) {
+      reset(target);
+      return;
+    }
+    if (target == _target) return;
+    _target = target;
+    _remaining = _rampSamples;
+    _step = (_target - _current) / static_cast<float>(_remaining);
+  }
+
+  void reset(float value) {
+    _current = _target = value;
+    _step = 0.0f;
+    _remaining = 0;
+    _initialized = true;
+  }
+
+  bool isRamping() const { return _remaining > 0; }
+  float getTarget() const { return _target; }
+
+  ml::DSPVector next() {
+    constexpr int kSize = static_cast<int>(ml::kFloatsPerDSPVector);
+    if (_remaining == 0) {
+      return ml::DSPVector(_current);
+    }
+
+    ml::DSPVector out;
+    float* py = out.getBuffer();
+    const int n = std::min(_remaining, kSize);
+    for (int i = 0; i < kSize; ++i) {
+      py[i] = (i < n) ? _current + _step * static_cast<float>(i + 1) : _target;
+    }
+
+    _remaining -= n;
+    _current = (_remaining == 0) ? _target : _current + _step * static_cast<float>(n);
+    return out;
+  }
+
+private:
+  float _current = 0.0f;
+  float _target = 0.0f;
+  float _step = 0.0f;
+  int _remaining = 0;
+  int _rampSamples = 1;
+  bool _initialized = false;
+};
+
+} // namespace dsp
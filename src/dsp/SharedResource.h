@@ -0,0 +1,45 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace dsp {
+
+// Process-wide registry of immutable resources shared between plugin instances.
+// acquire() returns the resource for key, building it on first use. The resource
+// lives as long as any instance holds the returned pointer and is freed with the
+// last one, so unloading every instance also releases the shared data.
+//
+// acquire() locks a mutex and may allocate: call it from constructors and
+// setSampleRate(), never from the process path. The resource itself is const and
+// can be read from any thread without locking.
+template <class T, class Key = int>
+class SharedResource {
+public:
+  template <class Build>
+  static std::shared_ptr<const T> acquire(const Key& key, Build build) {
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::weak_ptr<const T>& slot = registry.resources[key];
+    std::shared_ptr<const T> resource = slot.lock();
+    if (!resource) {
+      resource = std::shared_ptr<const T>(build());
+      slot = resource;
+    }
+    return resource;
+  }
+
+private:
+  struct Registry {
+    std::mutex mutex;
+    std::map<Key, std::weak_ptr<const T>> resources;
+  };
+
+  static Registry& getRegistry() {
+    static Registry registry;
+    return registry;
+  }
+};
+
+} // namespace dsp
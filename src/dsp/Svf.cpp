@@ -0,0 +1,31 @@
+#include "Svf.h"
+
+namespace dsp {
+
+SvfCoeffTable::SvfCoeffTable(float sampleRate)
+    : _sampleRate(sampleRate),
+      _freqScale(static_cast<float>(kFreqPoints - 1) / std::log2(std::min(kMaxHz, kMaxOmega * sampleRate) / kMinHz)),
+      _qScale(static_cast<float>(kQPoints - 1) / std::log2(kMaxQ / kMinQ)),
+      _entries(kFreqPoints * kQPoints),
+      _g(kFreqPoints),
+      _k(kQPoints) {
+  for (int i = 0; i < kFreqPoints; ++i) {
+    double hz = kMinHz * std::exp2(i / static_cast<double>(_freqScale));
+    _g[i] = static_cast<float>(std::tan(3.14159265358979323846 * hz / sampleRate));
+  }
+  for (int j = 0; j < kQPoints; ++j) {
+    _k[j] = static_cast<float>(1.0 / (kMinQ * std::exp2(j / static_cast<double>(_qScale))));
+  }
+  for (int j = 0; j < kQPoints; ++j) {
+    for (int i = 0; i < kFreqPoints; ++i) {
+      SvfCoeffs c = SvfCoeffs::fromG(_g[i], _k[j]);
+      _entries[j * kFreqPoints + i] = Entry{ { c.a1, c.a2, c.a3, 0.0f } };
+    }
+  }
+}
+
+std::shared_ptr<const SvfCoeffTable> SvfCoeffTable::acquire(float sampleRate) {
+  return SharedResource<SvfCoeffTable, float>::acquire(sampleRate, [sampleRate]() { return new SvfCoeffTable(sampleRate); });
+}
+
+} // namespace dsp
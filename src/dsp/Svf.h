@@ -0,0 +1,389 @@
+#pragma once
+
+#include "MLDSPOps.h"
+#include "FastTanh.h"
+#include "SharedResource.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <vector>
+
+namespace dsp {
+
+// Coefficients of the trapezoidal SVF: g = tan(pi * omega), k = 1 / Q,
+// and a1..a3 derived from g and k.
+struct SvfCoeffs {
+  float g = 0.0f;
+  float k = 1.0f;
+  float a1 = 1.0f;
+  float a2 = 0.0f;
+  float a3 = 0.0f;
+
+  // omega = frequency / sample rate, k = 1 / Q (k = 0 is maximum resonance)
+  static SvfCoeffs make(float omega, float k) {
+    return fromG(std::tan(ml::kPi * omega), k);
+  }
+
+  static SvfCoeffs fromG(float g, float k) {
+    SvfCoeffs c;
+    c.g = g;
+    c.k = k;
+    c.a1 = 1.0f / (1.0f + g * (g + k));
+    c.a2 = g * c.a1;
+    c.a3 = g * c.a2;
+    return c;
+  }
+
+  // Natural log of the per-sample decay factor of the slowest pole. The analog
+  // prototype poles s = p * wc, p = -k/2 +- sqrt(k^2/4 - 1), map through the
+  // bilinear transform to z = (1 + g p) / (1 - g p).
+  float decayPerSample() const {
+    const std::complex<double> root = std::sqrt(std::complex<double>(0.25 * k * k - 1.0, 0.0));
+    const std::complex<double> p = -0.5 * static_cast<double>(k) + root;
+    const std::complex<double> z = (1.0 + static_cast<double>(g) * p) / (1.0 - static_cast<double>(g) * p);
+    return static_cast<float>(-std::log(std::abs(z)));
+  }
+
+  // Samples for a free-running filter to decay from level "from" to level "to".
+  // Grows without bound as k approaches 0, so the result is capped at maxSamples.
+  int samplesToDecay(float from, float to, int maxSamples) const {
+    if (from <= to) return 0;
+    const float decay = decayPerSample();
+    const float samples = std::log(from / to) / std::max(decay, 1e-9f);
+    return static_cast<int>(std::min(samples, static_cast<float>(maxSamples)));
+  }
+};
+
+// SvfCoeffs precomputed over the lowpass parameter ranges for one sample rate, on
+// a grid that is logarithmic in both cutoff and Q, with bilinear interpolation of
+// a1..a3 between grid points. A lookup costs no tan() and no division, so it can
+// run per sample while the cutoff or Q is ramping.
+//
+// Grid: kFreqPoints from kMinHz up to kMaxHz or kMaxOmega * sample rate, whichever
+// is lower (about 60 per octave), by kQPoints over kMinQ..kMaxQ (16 per decade).
+// Against SvfCoeffs::make, from 22.05 to 192 kHz, the magnitude response differs
+// by at most about 0.02 dB below the cutoff and 0.05 dB around the resonant peak.
+class SvfCoeffTable {
+public:
+  static constexpr int kFreqPoints = 513;
+  static constexpr int kQPoints = 33;
+  static constexpr float kMinHz = 50.0f;
+  static constexpr float kMaxHz = 20000.0f;
+  static constexpr float kMinQ = 0.1f;
+  static constexpr float kMaxQ = 10.0f;
+  static constexpr float kMaxOmega = 0.45f;
+
+  // Fractional grid coordinates of a cutoff and Q
+  struct Position {
+    float freq = 0.0f;
+    float q = 0.0f;
+  };
+
+  explicit SvfCoeffTable(float sampleRate);
+
+  // The table for sampleRate, built on first use and shared by every instance
+  // running at that rate. Locks and may allocate, so not for the audio thread.
+  static std::shared_ptr<const SvfCoeffTable> acquire(float sampleRate);
+
+  float getSampleRate() const { return _sampleRate; }
+
+  // Grid coordinates of a cutoff in Hz and a Q, clamped to the table's range
+  Position locate(float hz, float q) const {
+    Position p;
+    p.freq = clampIndex(std::log2(hz / kMinHz) * _freqScale, kFreqPoints);
+    p.q = clampIndex(std::log2(q / kMinQ) * _qScale, kQPoints);
+    return p;
+  }
+
+  // Bilinear lookup of a1..a3. g and k are interpolated linearly along their own axis,
+  // which is exact at grid points and close enough for decay estimates in between.
+  SvfCoeffs lookup(Position p) const {
+    const int i = std::min(static_cast<int>(p.freq), kFreqPoints - 2);
+    const int j = std::min(static_cast<int>(p.q), kQPoints - 2);
+    const float fx = p.freq - static_cast<float>(i);
+    const float fy = p.q - static_cast<float>(j);
+
+    // Entries are padded to four floats so the three blends can run as one vector operation
+    const Entry* row0 = &_entries[j * kFreqPoints + i];
+    const Entry* row1 = row0 + kFreqPoints;
+    float a[4];
+    for (int n = 0; n < 4; ++n) {
+      const float v0 = row0[0].a[n] + fx * (row0[1].a[n] - row0[0].a[n]);
+      const float v1 = row1[0].a[n] + fx * (row1[1].a[n] - row1[0].a[n]);
+      a[n] = v0 + fy * (v1 - v0);
+    }
+
+    SvfCoeffs c;
+    c.a1 = a[0];
+    c.a2 = a[1];
+    c.a3 = a[2];
+    c.g = _g[i] + fx * (_g[i + 1] - _g[i]);
+    c.k = _k[j] + fy * (_k[j + 1] - _k[j]);
+    return c;
+  }
+
+  // g alone, interpolated along the frequency axis, for filters with a fixed k
+  // that compute a1..a3 themselves
+  float lookupG(float freq) const {
+    const int i = std::min(static_cast<int>(freq), kFreqPoints - 2);
+    return _g[i] + (freq - static_cast<float>(i)) * (_g[i + 1] - _g[i]);
+  }
+
+private:
+  float _sampleRate;
+  float _freqScale;  // grid points per octave
+  float _qScale;     // grid points per doubling of Q
+  struct alignas(16) Entry {
+    float a[4];  // a1, a2, a3, unused
+  };
+
+  std::vector<Entry> _entries;  // kQPoints rows of kFreqPoints
+  std::vector<float> _g;
+  std::vector<float> _k;
+
+  static float clampIndex(float x, int points) {
+    return std::max(0.0f, std::min(x, static_cast<float>(points - 1)));
+  }
+};
+
+// Arithmetic of the SvfLowpass recursion. kDouble keeps low cutoffs at high Q from
+// losing precision in the integrators, at roughly twice the cost per sample.
+// kAuto runs in double only where float falls short: once k^2 g drops below
+// 5e-5, about Q / sqrt(cutoff / sample rate) > 250, the float recursion's error
+// relative to the output peak grows past 1e-5.
+// Input and output stay float either way.
+enum class SvfPrecision { kFloat = 0, kDouble, kAuto };
+
+// Topology of the SvfLowpass feedback. kNonlinear passes the bandpass integrator
+// through tanh (the Pade kernel of FastTanh.h) before it is fed back, which bounds
+// the resonant peak near full scale; small signals see the linear response.
+enum class SvfMode { kLinear = 0, kNonlinear };
+
+// Trapezoidal state variable lowpass (Simper / Cytomic), the same topology and
+// response as ml::Lopass, for CHANNELS channels packed into one DSPVectorArray.
+// All channels share one set of coefficients and advance together in the
+// inner loop, so their independent recursions overlap in the pipeline, and with
+// four or more channels one SIMD instruction advances several of them.
+// Unlike ml::Lopass it can ramp its frequency and damping per sample, so
+// automated cutoff sweeps do not zipper. Ramps set with an SvfCoeffTable move
+// through the table's log-frequency and log-Q grid, looking up coefficients per
+// sample; ramps set with plain SvfCoeffs interpolate g and k linearly.
+// The recursion runs in float or double as set by setPrecision(), by default
+// choosing per vector from the coefficients; the integrator state is kept in
+// double either way, so switching precision doesn't click.
+// setMode() selects the linear or the saturating feedback path. The nonlinear
+// path adds one tanhPade per channel and sample, which vectorizes across channels
+// like the rest of the recursion.
+template <size_t CHANNELS>
+class SvfLowpass {
+public:
+  using Pack = ml::DSPVectorArray<CHANNELS>;
+
+  // Jump to new coefficients immediately
+  void setCoeffs(const SvfCoeffs& coeffs) {
+    _coeffs = coeffs;
+    _remaining = 0;
+    _initialized = true;
+    _table = nullptr;
+  }
+
+  // Ramp g and k linearly to the new coefficients over rampSamples samples.
+  // The first call after construction or reset() jumps immediately.
+  void setTarget(const SvfCoeffs& target, int rampSamples) {
+    if (!_initialized || rampSamples <= 0) {
+      setCoeffs(target);
+      return;
+    }
+    _target = target;
+    _remaining = rampSamples;
+    _table = nullptr;
+    _dg = (target.g - _coeffs.g) / static_cast<float>(rampSamples);
+    _dk = (target.k - _coeffs.k) / static_cast<float>(rampSamples);
+  }
+
+  // Ramp to a position in table over rampSamples samples. Jumps if the previous
+  // coefficients did not come from the same table. The table must stay alive
+  // until the next setTarget(), setCoeffs() or reset().
+  void setTarget(const SvfCoeffTable& table, SvfCoeffTable::Position target, int rampSamples) {
+    const SvfCoeffs coeffs = table.lookup(target);
+    if (!_initialized || rampSamples <= 0 || _table != &table) {
+      setCoeffs(coeffs);
+      _table = &table;
+      _position = _targetPosition = target;
+      return;
+    }
+    _target = coeffs;
+    _targetPosition = target;
+    _remaining = rampSamples;
+    _dFreq = (target.freq - _position.freq) / static_cast<float>(rampSamples);
+    _dQ = (target.q - _position.q) / static_cast<float>(rampSamples);
+  }
+
+  void reset() {
+    clearState();
+    _remaining = 0;
+    _initialized = false;
+    _table = nullptr;
+  }
+
+  // Finish any ramp in progress immediately
+  void jumpToTarget() {
+    if (_remaining > 0) {
+      _coeffs = _target;
+      _position = _targetPosition;
+      _remaining = 0;
+    }
+  }
+
+  // Zero the integrators but keep the coefficients and any ramp in progress
+  void clearState() {
+    std::fill(std::begin(ic1eq), std::end(ic1eq), 0.0);
+    std::fill(std::begin(ic2eq), std::end(ic2eq), 0.0);
+  }
+
+  void setPrecision(SvfPrecision precision) { _precision = precision; }
+  SvfPrecision getPrecision() const { return _precision; }
+
+  void setMode(SvfMode mode) { _mode = mode; }
+  SvfMode getMode() const { return _mode; }
+
+  bool isRamping() const { return _remaining > 0; }
+  const SvfCoeffs& getCoeffs() const { return _coeffs; }
+  // Where a ramp in progress ends, or the current coefficients
+  const SvfCoeffs& getTargetCoeffs() const { return _remaining > 0 ? _target : _coeffs; }
+
+  // Largest integrator state over all channels. Once the input is silent this
+  // bounds the output, so it tells when the filter has finished ringing.
+  float getStateMagnitude() const {
+    float m = 0.0f;
+    for (size_t c = 0; c < CHANNELS; ++c) {
+      m = std::max(m, static_cast<float>(std::fabs(ic1eq[c]) + std::fabs(ic2eq[c])));
+    }
+    return m;
+  }
+
+  // Whether kAuto runs the recursion in double for these coefficients
+  static bool needsDouble(const SvfCoeffs& c) { return c.k * c.k * c.g < kAutoDoubleBelow; }
+
+  // Whether the next process() runs in double
+  bool isDouble() const {
+    return _precision == SvfPrecision::kDouble ||
+           (_precision == SvfPrecision::kAuto && (needsDouble(_coeffs) || needsDouble(getTargetCoeffs())));
+  }
+
+  // Filter all channels in place
+  void process(Pack& samples) {
+    const bool nonlinear = _mode == SvfMode::kNonlinear;
+    if (isDouble()) {
+      nonlinear ? processWith<double, true>(samples) : processWith<double, false>(samples);
+    } else {
+      nonlinear ? processWith<float, true>(samples) : processWith<float, false>(samples);
+    }
+  }
+
+  // Integrator states, one per channel
+  double ic1eq[CHANNELS] = {};
+  double ic2eq[CHANNELS] = {};
+
+private:
+  static constexpr float kAutoDoubleBelow = 5e-5f;
+
+  SvfCoeffs _coeffs;
+  SvfCoeffs _target;
+  float _dg = 0.0f;
+  float _dk = 0.0f;
+  int _remaining = 0;
+  bool _initialized = false;
+  SvfPrecision _precision = SvfPrecision::kAuto;
+  SvfMode _mode = SvfMode::kLinear;
+
+  // Table the current coefficients came from, or null
+  const SvfCoeffTable* _table = nullptr;
+  SvfCoeffTable::Position _position;
+  SvfCoeffTable::Position _targetPosition;
+  float _dFreq = 0.0f;
+  float _dQ = 0.0f;
+
+  // The recursion with state and arithmetic in T, saturating the feedback if
+  // NONLINEAR. Samples are converted on the way in and out; coefficients are
+  // computed in float and widened per block.
+  template <typename T, bool NONLINEAR>
+  void processWith(Pack& samples) {
+    constexpr int kSize = static_cast<int>(ml::kFloatsPerDSPVector);
+    float* p = samples.getBuffer();
+
+    // The recursion runs on local copies of the state, which the compiler can keep in
+    // registers and advance for several channels with one SIMD instruction per step
+    T s1[CHANNELS], s2[CHANNELS];
+    for (size_t c = 0; c < CHANNELS; ++c) {
+      s1[c] = static_cast<T>(ic1eq[c]);
+      s2[c] = static_cast<T>(ic2eq[c]);
+    }
+
+    int i = 0;
+    if (_remaining > 0 && _table) {
+      // Table ramp section: advance the grid position per sample and look up a1..a3.
+      // The lookups don't depend on the filter state, so they run first as a separate
+      // loop instead of adding to the latency of the recursion.
+      const int n = std::min(_remaining, kSize);
+      float a1[kSize], a2[kSize], a3[kSize];
+      SvfCoeffTable::Position position = _position;
+      for (int j = 0; j < n; ++j) {
+        position.freq += _dFreq;
+        position.q += _dQ;
+        const SvfCoeffs c = _table->lookup(position);
+        a1[j] = c.a1;
+        a2[j] = c.a2;
+        a3[j] = c.a3;
+      }
+      for (; i < n; ++i) {
+        tick<T, NONLINEAR>(p, i, s1, s2, a1[i], a2[i], a3[i]);
+      }
+      _remaining -= n;
+      _position = (_remaining == 0) ? _targetPosition : position;
+      _coeffs = (_remaining == 0) ? _target : _table->lookup(position);
+    } else if (_remaining > 0) {
+      // Ramp section: advance g and k per sample and re-derive a1..a3
+      const int n = std::min(_remaining, kSize);
+      float g = _coeffs.g;
+      float k = _coeffs.k;
+      for (; i < n; ++i) {
+        g += _dg;
+        k += _dk;
+        float a1 = 1.0f / (1.0f + g * (g + k));
+        float a2 = g * a1;
+        tick<T, NONLINEAR>(p, i, s1, s2, a1, a2, g * a2);
+      }
+      _remaining -= n;
+      _coeffs = (_remaining == 0) ? _target : SvfCoeffs::fromG(g, k);
+    }
+
+    // Static section
+    const T a1 = _coeffs.a1, a2 = _coeffs.a2, a3 = _coeffs.a3;
+    for (; i < kSize; ++i) {
+      tick<T, NONLINEAR>(p, i, s1, s2, a1, a2, a3);
+    }
+
+    std::copy(s1, s1 + CHANNELS, ic1eq);
+    std::copy(s2, s2 + CHANNELS, ic2eq);
+  }
+
+  // One sample of every channel; channel c of sample i is at p[c * kFloatsPerDSPVector + i].
+  // The nonlinear path replaces the bandpass state by tanh of it wherever it is read.
+  template <typename T, bool NONLINEAR>
+  static inline void tick(float* p, int i, T* s1, T* s2, T a1, T a2, T a3) {
+    for (size_t c = 0; c < CHANNELS; ++c) {
+      float& x = p[c * ml::kFloatsPerDSPVector + i];
+      T bp = NONLINEAR ? tanhPade(s1[c]) : s1[c];
+      T v3 = static_cast<T>(x) - s2[c];
+      T v1 = a1 * bp + a2 * v3;
+      T v2 = s2[c] + a2 * bp + a3 * v3;
+      s1[c] = T(2) * v1 - bp;
+      s2[c] = T(2) * v2 - s2[c];
+      x = static_cast<float>(v2);
+    }
+  }
+};
+
+} // namespace dsp
@@ -0,0 +1,42 @@
+#include "TanhAdaa.h"
+
+namespace dsp {
+
+namespace {
+
+constexpr double kLn2 = 0.69314718055994530942;
+constexpr double kPiSquaredOver24 = 0.41123351671205660160;
+
+// Li2(-u) for u in [0, 1], via the Landen identity
+// Li2(z) = -Li2(z / (z - 1)) - ln^2(1 - z) / 2, which maps the argument into
+// [0, 0.5] where the power series converges quickly.
+double dilogarithmOfNegative(double u) {
+  const double w = u / (1.0 + u);
+  double wk = w;
+  double sum = 0.0;
+  for (int k = 1; k < 64; ++k) {
+    double term = wk / (static_cast<double>(k) * k);
+    sum += term;
+    if (term < 1e-17 * sum) break;
+    wk *= w;
+  }
+  const double l = std::log1p(u);
+  return -sum - 0.5 * l * l;
+}
+
+} // namespace
+
+double tanhAntiderivative1(double x) {
+  const double a = std::fabs(x);
+  return a + std::log1p(std::exp(-2.0 * a)) - kLn2;
+}
+
+double tanhAntiderivative2(double x) {
+  // For x >= 0, using log(cosh(t)) = t + log(1 + e^-2t) - ln 2:
+  // F2(x) = x^2 / 2 - x ln 2 + pi^2 / 24 + Li2(-e^-2x) / 2. F2 is odd.
+  const double a = std::fabs(x);
+  const double f = 0.5 * a * a - a * kLn2 + kPiSquaredOver24 + 0.5 * dilogarithmOfNegative(std::exp(-2.0 * a));
+  return x < 0.0 ? -f : f;
+}
+
+} // namespace dsp
@@ -0,0 +1,306 @@
+#pragma once
+
+#include "FastTanh.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Antiderivative anti-aliasing (ADAA) for the tanh saturator.
+//
+// Instead of sampling tanh(x) directly, ADAA outputs the average of tanh over
+// the segment between consecutive input samples, computed in closed form from
+// antiderivatives. This suppresses most aliasing for a fraction of the cost of
+// oversampling, at the price of a gentle high-frequency rolloff and a small delay.
+//
+//   kFirst   F1(x) = log(cosh(x)). Vectorized over the DSPVector in float.
+//            Half a sample of delay. Roughly 2-3x the cost of the kStandard kernel.
+//   kSecond  F2(x) = integral of log(cosh(x)), which needs the dilogarithm.
+//            Vectorized over the DSPVector in double, for numerical stability,
+//            with branch-free polynomial exp, log1p and dilogarithm kernels.
+//            One sample of delay. Roughly 1.5-3x the cost of first order.
+//
+// When consecutive inputs are too close for the difference quotients to be well
+// conditioned, both orders fall back to evaluating the nonlinearity at the midpoint.
+namespace dsp {
+
+enum class AdaaOrder { kOff = 0, kFirst, kSecond };
+
+// log(cosh(x)), first antiderivative of tanh
+double tanhAntiderivative1(double x);
+// integral of log(cosh(x)) from 0 to x, second antiderivative of tanh
+double tanhAntiderivative2(double x);
+
+// Below this input difference the first-order divided difference is
+// ill-conditioned in float and the midpoint fallback is more accurate.
+constexpr float kAdaaFirstOrderEpsilon = 1e-2f;
+
+// Below this input difference the second-order divided differences are
+// ill-conditioned and the midpoint fallbacks are more accurate.
+constexpr double kAdaaSecondOrderEpsilon = 1e-4;
+
+// e^y for y <= 0 in double: range reduction by ln 2 (Cody-Waite), a degree 13
+// Taylor polynomial on [-ln2 / 2, ln2 / 2] and an exponent built from the integer
+// part. Relative error 2.2e-16 down to e^-708, zero below.
+inline double adaaExpNonPositive(double y) {
+  constexpr double kLog2e = 1.4426950408889634074;
+  constexpr double kLn2Hi = 6.93147180369123816490e-01;
+  constexpr double kLn2Lo = 1.90821492927058770002e-10;
+  constexpr double kRound = 6755399441055744.0; // 1.5 * 2^52
+  const double shifted = y * kLog2e + kRound;
+  const double k = shifted - kRound;
+  const double r = (y - k * kLn2Hi) - k * kLn2Lo;
+  double p = 1.0 / 6227020800.0;
+  p = p * r + 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+  int64_t shiftedBits, roundBits;
+  std::memcpy(&shiftedBits, &shifted, sizeof(double));
+  std::memcpy(&roundBits, &kRound, sizeof(double));
+  // Results below the normal range flush to zero through a mask rather than
+  // a compare, which SSE2 lacks for 64-bit integers.
+  const uint64_t biased = static_cast<uint64_t>(shiftedBits - roundBits + 1023);
+  const uint64_t keep = (biased >> 63) - 1;
+  const uint64_t scaleBits = (biased << 52) & keep;
+  double scale;
+  std::memcpy(&scale, &scaleBits, sizeof(double));
+  return p * scale;
+}
+
+// log(1 + u) for u in [0, 1] as 2 atanh(u / (2 + u)), whose odd series in
+// s = u / (2 + u) <= 1/3 converges to double precision in 17 terms.
+inline double adaaLog1pUnit(double u) {
+  const double s = u / (2.0 + u);
+  const double s2 = s * s;
+  double p = 1.0 / 33.0;
+  p = p * s2 + 1.0 / 31.0;
+  p = p * s2 + 1.0 / 29.0;
+  p = p * s2 + 1.0 / 27.0;
+  p = p * s2 + 1.0 / 25.0;
+  p = p * s2 + 1.0 / 23.0;
+  p = p * s2 + 1.0 / 21.0;
+  p = p * s2 + 1.0 / 19.0;
+  p = p * s2 + 1.0 / 17.0;
+  p = p * s2 + 1.0 / 15.0;
+  p = p * s2 + 1.0 / 13.0;
+  p = p * s2 + 1.0 / 11.0;
+  p = p * s2 + 1.0 / 9.0;
+  p = p * s2 + 1.0 / 7.0;
+  p = p * s2 + 1.0 / 5.0;
+  p = p * s2 + 1.0 / 3.0;
+  p = p * s2 + 1.0;
+  return 2.0 * s * p;
+}
+
+// tanh(x) and its first two antiderivatives, branch-free in double so the loops
+// calling it vectorize. With u = e^-2|x| and l = log(1 + u), Li2(-u) follows from
+// the Landen identity as -Li2(u / (1 + u)) - l^2 / 2, and Li2(u / (1 + u)) =
+// Li2(1 - e^-l) is a Bernoulli series in l, truncated here at l^17 (l <= ln 2).
+// Max absolute error against tanhAntiderivative1/2 on [-20, 20] is 1.8e-15 for
+// F1 and 4.4e-16 for F2.
+inline void adaaTanhAntiderivatives(double x, double& tanhX, double& f1, double& f2) {
+  constexpr double kLn2 = 0.69314718055994530942;
+  constexpr double kPiSquaredOver24 = 0.41123351671205660160;
+  const double a = std::fabs(x);
+  const double u = adaaExpNonPositive(-2.0 * a);
+  const double l = adaaLog1pUnit(u);
+  const double l2 = l * l;
+  double p = -1.9939295860721074e-14;
+  p = p * l2 + 8.921691020456452e-13;
+  p = p * l2 - 4.0647616451442256e-11;
+  p = p * l2 + 1.8978869988971e-09;
+  p = p * l2 - 9.185773074661964e-08;
+  p = p * l2 + 4.72411186696901e-06;
+  p = p * l2 - 2.777777777777778e-04;
+  p = p * l2 + 2.777777777777778e-02;
+  const double li2NegU = -(l - 0.25 * l2 + l * l2 * p) - 0.5 * l2;
+  const double sign = std::copysign(1.0, x);
+  tanhX = sign * (1.0 - u) / (1.0 + u);
+  f1 = a - kLn2 + l;
+  f2 = sign * (0.5 * a * a - a * kLn2 + kPiSquaredOver24 + 0.5 * li2NegU);
+}
+
+// ADAA state for CHANNELS channels packed into one DSPVectorArray.
+// Changing the order clears the state.
+template <size_t CHANNELS>
+class TanhAdaa {
+public:
+  using Pack = ml::DSPVectorArray<CHANNELS>;
+
+  TanhAdaa() { reset(); }
+
+  void setOrder(AdaaOrder order) {
+    if (order != _order) {
+      _order = order;
+      reset();
+    }
+  }
+
+  AdaaOrder getOrder() const { return _order; }
+
+  // Delay in samples at the rate the ADAA runs at
+  static float delayFor(AdaaOrder order) {
+    return (order == AdaaOrder::kFirst) ? 0.5f : (order == AdaaOrder::kSecond) ? 1.0f : 0.0f;
+  }
+
+  void reset() {
+    for (size_t c = 0; c < CHANNELS; ++c) {
+      _x1[c] = 0.0f;
+      _g1[c] = std::log(2.0f);
+      _sx1[c] = _sx2[c] = 0.0;
+    }
+  }
+
+  // tanh(x) with anti-aliasing; the fallback path uses the given kernel tier
+  Pack process(const Pack& x, TanhQuality quality) {
+    switch (_order) {
+      case AdaaOrder::kFirst: return processFirstOrder(x, quality);
+      case AdaaOrder::kSecond: return processSecondOrder(x);
+      default: return tanhKernel(quality, x);
+    }
+  }
+
+private:
+  static constexpr int kSize = static_cast<int>(ml::kFloatsPerDSPVector);
+
+  AdaaOrder _order = AdaaOrder::kOff;
+
+  // first order state: previous input and its log(1 + exp(-2|x|)) term
+  float _x1[CHANNELS];
+  float _g1[CHANNELS];
+
+  // second order state: the previous two inputs
+  double _sx1[CHANNELS];
+  double _sx2[CHANNELS];
+
+  Pack processFirstOrder(const Pack& x, TanhQuality quality) {
+    // log(cosh(x)) = |x| + g(x) - ln 2 with g(x) = log(1 + e^-2|x|). Taking the
+    // difference of the |x| and g terms separately keeps the cancellation error
+    // bounded by the size of g, which never exceeds ln 2.
+    Pack absX = vabs(x);
+    Pack g = vlog(Pack(1.0f) + vexp(Pack(-2.0f) * absX));
+
+    // Inputs delayed by one sample
+    Pack xPrev, gPrev;
+    for (size_t c = 0; c < CHANNELS; ++c) {
+      const int row = static_cast<int>(c) * kSize;
+      xPrev[row] = _x1[c];
+      gPrev[row] = _g1[c];
+      for (int i = 1; i < kSize; ++i) {
+        xPrev[row + i] = x[row + i - 1];
+        gPrev[row + i] = g[row + i - 1];
+      }
+      _x1[c] = x[row + kSize - 1];
+      _g1[c] = g[row + kSize - 1];
+    }
+
+    // Midpoint fallback, evaluated for the whole pack so the select below stays branch-free
+    Pack midpoint = tanhKernel(quality, (x + xPrev) * Pack(0.5f));
+
+    Pack y;
+    const float* px = x.getConstBuffer();
+    const float* pxPrev = xPrev.getConstBuffer();
+    const float* pAbs = absX.getConstBuffer();
+    const float* pg = g.getConstBuffer();
+    const float* pgPrev = gPrev.getConstBuffer();
+    const float* pMid = midpoint.getConstBuffer();
+    float* py = y.getBuffer();
+    for (int i = 0; i < static_cast<int>(CHANNELS) * kSize; ++i) {
+      float dx = px[i] - pxPrev[i];
+      bool illConditioned = std::fabs(dx) < kAdaaFirstOrderEpsilon;
+      float safeDx = illConditioned ? 1.0f : dx;
+      float quotient = ((pAbs[i] - std::fabs(pxPrev[i])) + (pg[i] - pgPrev[i])) / safeDx;
+      py[i] = illConditioned ? pMid[i] : quotient;
+    }
+    return y;
+  }
+
+  Pack processSecondOrder(const Pack& x) {
+    // Points are the two previous inputs followed by the block, so the
+    // divided differences for every output come from one pass of the kernel.
+    constexpr int kPoints = kSize + 2;
+    constexpr double kEpsilon = kAdaaSecondOrderEpsilon;
+    Pack y;
+    for (size_t c = 0; c < CHANNELS; ++c) {
+      const int row = static_cast<int>(c) * kSize;
+      double px[kPoints], pf1[kPoints], pf2[kPoints], d[kSize + 1], out[kSize];
+      px[0] = _sx2[c];
+      px[1] = _sx1[c];
+      for (int i = 0; i < kSize; ++i) px[i + 2] = x[row + i];
+      for (int j = 0; j < kPoints; ++j) {
+        double t;
+        adaaTanhAntiderivatives(px[j], t, pf1[j], pf2[j]);
+      }
+
+      // First divided differences of F2, and the trapezoid of F1 where the inputs
+      // are close. Both sides of each select are computed into arrays first:
+      // with trapping math the compiler only if-converts selects between loads.
+      double quotient[kSize + 1], trapezoid[kSize + 1];
+      for (int j = 0; j <= kSize; ++j) {
+        const double dx = px[j + 1] - px[j];
+        const double safeDx = (std::fabs(dx) < kEpsilon) ? 1.0 : dx;
+        quotient[j] = (pf2[j + 1] - pf2[j]) / safeDx;
+        trapezoid[j] = 0.5 * (pf1[j + 1] + pf1[j]);
+      }
+      for (int j = 0; j <= kSize; ++j) {
+        d[j] = (std::fabs(px[j + 1] - px[j]) < kEpsilon) ? trapezoid[j] : quotient[j];
+      }
+
+      // Second divided differences. Counting the ill-conditioned outputs in
+      // the same loop would keep it from vectorizing.
+      for (int i = 0; i < kSize; ++i) {
+        const double dx2 = px[i + 2] - px[i];
+        const double safeDx2 = (std::fabs(dx2) < kEpsilon) ? 1.0 : dx2;
+        out[i] = 2.0 * (d[i + 1] - d[i]) / safeDx2;
+      }
+      int illConditionedCount = 0;
+      for (int i = 0; i < kSize; ++i) {
+        illConditionedCount += (std::fabs(px[i + 2] - px[i]) < kEpsilon);
+      }
+
+      // Where x[n] ~ x[n-2], expand around x[n-1] instead, or take tanh at the
+      // midpoint when all three are close. The pass only runs for blocks that
+      // need it, and then branch-free over the whole block.
+      if (illConditionedCount > 0) {
+        double point[kSize], midpoint[kSize], pointF1[kSize], pointF2[kSize], expanded[kSize];
+        for (int i = 0; i < kSize; ++i) {
+          const double xBar = 0.5 * (px[i + 2] + px[i]);
+          const double delta = xBar - px[i + 1];
+          point[i] = xBar - ((std::fabs(delta) < kEpsilon) ? 0.5 : 0.0) * delta;
+        }
+        for (int i = 0; i < kSize; ++i) {
+          adaaTanhAntiderivatives(point[i], midpoint[i], pointF1[i], pointF2[i]);
+        }
+        for (int i = 0; i < kSize; ++i) {
+          const double delta = 0.5 * (px[i + 2] + px[i]) - px[i + 1];
+          // Shifted off zero rather than replaced by a constant, which the
+          // compiler would fold into a separate branch
+          const double safeDelta = delta + ((std::fabs(delta) < kEpsilon) ? 2.0 * kEpsilon : 0.0);
+          expanded[i] = (2.0 / safeDelta) * (pointF1[i] + (pf2[i + 1] - pointF2[i]) / safeDelta);
+        }
+        for (int i = 0; i < kSize; ++i) {
+          const bool nearMiddle = std::fabs(0.5 * (px[i + 2] + px[i]) - px[i + 1]) < kEpsilon;
+          const double fallback = nearMiddle ? midpoint[i] : expanded[i];
+          const bool illConditioned = std::fabs(px[i + 2] - px[i]) < kEpsilon;
+          y[row + i] = static_cast<float>(illConditioned ? fallback : out[i]);
+        }
+      } else {
+        for (int i = 0; i < kSize; ++i) y[row + i] = static_cast<float>(out[i]);
+      }
+      _sx2[c] = px[kSize];
+      _sx1[c] = px[kSize + 1];
+    }
+    return y;
+  }
+};
+
+} // namespace dsp
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "MLDSPOps.h"
+#include <algorithm>
+#include <array>
+
+namespace dsp {
+
+// Delays each of LANES channels by the same whole number of samples, from 0 up to
+// one DSPVector, by keeping the previous input vector of every lane. Lines the dry
+// signal up with the latency of the wet path.
+template <size_t LANES>
+class VectorDelay {
+public:
+  static constexpr int kMaxDelay = static_cast<int>(ml::kFloatsPerDSPVector);
+
+  // Changing the delay clears the history
+  void setDelay(int samples) {
+    samples = std::max(0, std::min(samples, kMaxDelay));
+    if (samples != _delay) {
+      _delay = samples;
+      reset();
+    }
+  }
+
+  int getDelay() const { return _delay; }
+
+  void reset() {
+    for (auto& history : _history) history.fill(0.0f);
+  }
+
+  // The input of one lane, delayed
+  ml::DSPVector process(size_t lane, const ml::DSPVector& input) {
+    if (_delay == 0) return input;
+    ml::DSPVector output;
+    const float* in = input.getConstBuffer();
+    float* out = output.getBuffer();
+    float* history = _history[lane].data();
+    std::copy(history + kMaxDelay - _delay, history + kMaxDelay, out);
+    std::copy(in, in + kMaxDelay - _delay, out + _delay);
+    std::copy(in, in + kMaxDelay, history);
+    return output;
+  }
+
+  // Keeps one lane's history current while its output isn't needed
+  void write(size_t lane, const ml::DSPVector& input) {
+    if (_delay == 0) return;
+    std::copy(input.getConstBuffer(), input.getConstBuffer() + kMaxDelay, _history[lane].data());
+  }
+
+private:
+  int _delay = 0;
+  std::array<std::array<float, ml::kFloatsPerDSPVector>, LANES> _history{};
+};
+
+} // namespace dsp
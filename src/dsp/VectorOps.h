@@ -0,0 +1,65 @@
+#pragma once
+
+#include "MLDSPOps.h"
+#include <algorithm>
+#include <cmath>
+
+// Overloads that let a DSP kernel be written once and instantiated for plain
+// scalars (float/double) as well as ml::DSPVectorArray<ROWS>.
+namespace dsp {
+
+inline float vmin(float a, float b) { return std::min(a, b); }
+inline float vmax(float a, float b) { return std::max(a, b); }
+inline float vabs(float a) { return std::fabs(a); }
+inline float vexp(float a) { return std::exp(a); }
+inline float vlog(float a) { return std::log(a); }
+
+inline double vmin(double a, double b) { return std::min(a, b); }
+inline double vmax(double a, double b) { return std::max(a, b); }
+inline double vabs(double a) { return std::fabs(a); }
+inline double vexp(double a) { return std::exp(a); }
+inline double vlog(double a) { return std::log(a); }
+
+template <size_t ROWS>
+inline ml::DSPVectorArray<ROWS> vmin(const ml::DSPVectorArray<ROWS>& a, const ml::DSPVectorArray<ROWS>& b) {
+  return ml::min(a, b);
+}
+
+template <size_t ROWS>
+inline ml::DSPVectorArray<ROWS> vmax(const ml::DSPVectorArray<ROWS>& a, const ml::DSPVectorArray<ROWS>& b) {
+  return ml::max(a, b);
+}
+
+template <size_t ROWS>
+inline ml::DSPVectorArray<ROWS> vabs(const ml::DSPVectorArray<ROWS>& a) {
+  return ml::max(a, ml::DSPVectorArray<ROWS>(0.0f) - a);
+}
+
+template <size_t ROWS>
+inline ml::DSPVectorArray<ROWS> vexp(const ml::DSPVectorArray<ROWS>& a) {
+  return ml::exp(a);
+}
+
+template <size_t ROWS>
+inline ml::DSPVectorArray<ROWS> vlog(const ml::DSPVectorArray<ROWS>& a) {
+  return ml::log(a);
+}
+
+// Clamp x to [lo, hi]. Bounds are scalars and are splatted for vector types.
+template <typename V, typename S>
+inline V vclamp(const V& x, S lo, S hi) {
+  return vmin(vmax(x, V(lo)), V(hi));
+}
+
+// Largest absolute sample value in x
+template <size_t ROWS>
+inline float peakAbs(const ml::DSPVectorArray<ROWS>& x) {
+  const float* p = x.getConstBuffer();
+  float peak = 0.0f;
+  for (size_t i = 0; i < ROWS * ml::kFloatsPerDSPVector; ++i) {
+    peak = std::max(peak, std::fabs(p[i]));
+  }
+  return peak;
+}
+
+} // namespace dsp
@@ -0,0 +1,193 @@
+#include "AnalyzerWidget.h"
+#include "dsp/FastTanh.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace ml;
+
+namespace
+{
+  // Display ranges
+  constexpr float kMinFrequency = 20.f;
+  constexpr float kMinDb = -90.f;
+  constexpr float kMaxDb = 12.f;
+  constexpr float kMaxInput = 2.f;
+
+  float dbToY(const Rect& r, float db)
+  {
+    float t = (std::clamp(db, kMinDb, kMaxDb) - kMinDb) / (kMaxDb - kMinDb);
+    return r.bottom() - t * r.height();
+  }
+}
+
+AnalyzerWidget::AnalyzerWidget(WithValues p) : Widget(p)
+{
+  _window.resize(kFftSize);
+  for (int i = 0; i < kFftSize; ++i)
+  {
+    _window[i] = 0.5f - 0.5f * std::cos(2.f * ml::kPi * i / kFftSize);
+  }
+  _history.assign(kFftSize, 0.f);
+  _fftBuffer.resize(kFftSize);
+  _spectrumDb.assign(kFftSize / 2 + 1, kMinDb);
+}
+
+void AnalyzerWidget::addBlock(const AnalyzerBlock& block)
+{
+  // A rate change invalidates the history
+  if (block.sampleRate != _sampleRate)
+  {
+    std::fill(_history.begin(), _history.end(), 0.f);
+    std::fill(_spectrumDb.begin(), _spectrumDb.end(), kMinDb);
+  }
+
+  _settings = block.settings;
+  _hostSampleRate = block.hostSampleRate;
+  _sampleRate = block.sampleRate;
+  _inputPeak = std::max(_inputPeak * 0.99f, block.inputPeak);
+
+  for (int i = 0; i < block.size; ++i)
+  {
+    _history[_writeIndex] = block.samples[i];
+    _writeIndex = (_writeIndex + 1) % kFftSize;
+  }
+  _newSamples += block.size;
+}
+
+void AnalyzerWidget::update()
+{
+  if (_newSamples == 0) return;
+  _newSamples = 0;
+
+  // Windowed copy of the history, oldest sample first
+  for (int i = 0; i < kFftSize; ++i)
+  {
+    _fftBuffer[i] = _history[(_writeIndex + i) % kFftSize] * _window[i];
+  }
+  _fft.forward(_fftBuffer.data());
+
+  // Scale so a full-scale sine reads 0 dB (the Hann window's coherent gain is 0.5),
+  // then rise immediately and fall smoothly
+  const float scale = 4.f / kFftSize;
+  for (size_t i = 0; i < _spectrumDb.size(); ++i)
+  {
+    float db = 20.f * std::log10(std::abs(_fftBuffer[i]) * scale + 1e-9f);
+    _spectrumDb[i] = std::max(db, _spectrumDb[i] - 1.5f);
+  }
+
+  // Setting a property marks the widget for redraw
+  setFloatProperty("peak", _inputPeak);
+}
+
+void AnalyzerWidget::draw(ml::DrawContext dc)
+{
+  NativeDrawContext* nvg = getNativeContext(dc);
+  Rect bounds = getLocalBounds(dc, *this);
+
+  bool enabled = getBoolPropertyWithDefault("enabled", true);
+  if(!enabled) return;
+
+  auto color = getColorPropertyWithDefault("color", getColor(dc, "mark"));
+  float opacity = getFloatPropertyWithDefault("opacity", 1.0f);
+  NVGcolor lineColor = multiplyAlpha(color, opacity);
+
+  // Square transfer curve on the left, spectrum in the rest
+  float gap = bounds.height() * 0.2f;
+  Rect curveRect(bounds.left(), bounds.top(), bounds.height(), bounds.height());
+  Rect spectrumRect(bounds.left() + bounds.height() + gap, bounds.top(),
+                    bounds.width() - bounds.height() - gap, bounds.height());
+
+  drawTransferCurve(nvg, curveRect, lineColor);
+  drawSpectrum(nvg, spectrumRect, lineColor);
+}
+
+void AnalyzerWidget::drawTransferCurve(NativeDrawContext* nvg, Rect r, NVGcolor color)
+{
+  // Frame and axes
+  nvgBeginPath(nvg);
+  nvgRect(nvg, r.left(), r.top(), r.width(), r.height());
+  nvgMoveTo(nvg, r.left(), r.center().y());
+  nvgLineTo(nvg, r.right(), r.center().y());
+  nvgMoveTo(nvg, r.center().x(), r.top());
+  nvgLineTo(nvg, r.center().x(), r.bottom());
+  nvgStrokeColor(nvg, multiplyAlpha(color, 0.3f));
+  nvgStrokeWidth(nvg, 1.0f);
+  nvgStroke(nvg);
+
+  // Input peak, before input gain
+  float peakX = std::min(_inputPeak, kMaxInput) / kMaxInput * r.width() * 0.5f;
+  nvgBeginPath(nvg);
+  nvgRect(nvg, r.center().x() - peakX, r.top(), 2.f * peakX, r.height());
+  nvgFillColor(nvg, multiplyAlpha(color, 0.1f));
+  nvgFill(nvg);
+
+  // out = outputGain * tanh(inputGain * in), with the kernel tier in use
+  auto quality = static_cast<dsp::TanhQuality>(_settings.quality);
+  constexpr int kPoints = 96;
+  nvgBeginPath(nvg);
+  for (int i = 0; i <= kPoints; ++i)
+  {
+    float in = kMaxInput * (2.f * i / kPoints - 1.f);
+    float out = _settings.outputGain * dsp::tanhKernel(quality, _settings.inputGain * in);
+    float x = r.left() + r.width() * i / kPoints;
+    float y = r.center().y() - std::clamp(out, -1.f, 1.f) * r.height() * 0.5f;
+    if (i == 0) nvgMoveTo(nvg, x, y); else nvgLineTo(nvg, x, y);
+  }
+  nvgStrokeColor(nvg, color);
+  nvgStrokeWidth(nvg, 2.0f);
+  nvgStroke(nvg);
+}
+
+void AnalyzerWidget::drawSpectrum(NativeDrawContext* nvg, Rect r, NVGcolor color)
+{
+  const float maxFrequency = _sampleRate * 0.5f;
+  const float logRange = std::log(maxFrequency / kMinFrequency);
+  auto frequencyToX = [&](float f) { return r.left() + r.width() * std::log(f / kMinFrequency) / logRange; };
+
+  // Frame and 0 dB line
+  nvgBeginPath(nvg);
+  nvgRect(nvg, r.left(), r.top(), r.width(), r.height());
+  nvgMoveTo(nvg, r.left(), dbToY(r, 0.f));
+  nvgLineTo(nvg, r.right(), dbToY(r, 0.f));
+  nvgStrokeColor(nvg, multiplyAlpha(color, 0.3f));
+  nvgStrokeWidth(nvg, 1.0f);
+  nvgStroke(nvg);
+
+  // Output spectrum, skipping bins below the display range
+  const float binHz = _sampleRate / kFftSize;
+  nvgBeginPath(nvg);
+  bool started = false;
+  for (size_t i = 1; i < _spectrumDb.size(); ++i)
+  {
+    float f = i * binHz;
+    if (f < kMinFrequency) continue;
+    float x = frequencyToX(f);
+    float y = dbToY(r, _spectrumDb[i]);
+    if (!started) { nvgMoveTo(nvg, x, y); started = true; } else nvgLineTo(nvg, x, y);
+  }
+  nvgStrokeColor(nvg, multiplyAlpha(color, 0.6f));
+  nvgStrokeWidth(nvg, 1.0f);
+  nvgStroke(nvg);
+
+  if (!_settings.filterActive) return;
+
+  // Lowpass magnitude. The trapezoidal SVF is the bilinear transform of the analog
+  // prototype, so |H| = 1 / sqrt((1 - w^2)^2 + (k w)^2) with w = tan(pi f / fs) / g.
+  const float cutoff = std::min(_settings.lowpassHz, 0.45f * _hostSampleRate);
+  const float g = std::tan(ml::kPi * cutoff / _hostSampleRate);
+  const float k = 1.f / _settings.lowpassQ;
+  constexpr int kPoints = 128;
+  nvgBeginPath(nvg);
+  for (int i = 0; i <= kPoints; ++i)
+  {
+    float f = kMinFrequency * std::exp(logRange * i / kPoints);
+    float w = std::tan(ml::kPi * std::min(f / _hostSampleRate, 0.499f)) / g;
+    float magnitude = 1.f / std::sqrt((1.f - w * w) * (1.f - w * w) + (k * w) * (k * w));
+    float x = frequencyToX(f);
+    float y = dbToY(r, 20.f * std::log10(magnitude + 1e-9f));
+    if (i == 0) nvgMoveTo(nvg, x, y); else nvgLineTo(nvg, x, y);
+  }
+  nvgStrokeColor(nvg, color);
+  nvgStrokeWidth(nvg, 2.0f);
+  nvgStroke(nvg);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "MLWidget.h"
+#include "AnalyzerTap.h"
+#include "dsp/Fft.h"
+#include <complex>
+#include <vector>
+
+using namespace ml;
+
+// Analyzer view: the saturator's transfer curve at the current gains with the
+// input peak marked, and a spectrum of the output with the lowpass response
+// overlaid. Fed on the GUI thread with blocks drained from AnalyzerTap; the FFT
+// runs in update(), which the GUI calls at its display rate.
+class AnalyzerWidget : public Widget
+{
+public:
+  static constexpr int kFftSize = 2048;
+
+  AnalyzerWidget(WithValues p);
+
+  void addBlock(const AnalyzerBlock& block);
+
+  // Recompute the spectrum if new audio arrived since the last call
+  void update();
+
+  // Widget implementation
+  void draw(ml::DrawContext dc) override;
+
+private:
+  dsp::Fft _fft{kFftSize};
+  std::vector<float> _window;
+  std::vector<float> _history;
+  std::vector<std::complex<float>> _fftBuffer;
+  std::vector<float> _spectrumDb;
+  int _writeIndex{0};
+  int _newSamples{0};
+
+  AnalyzerSettings _settings;
+  float _hostSampleRate{48000.f};
+  float _sampleRate{48000.f};
+  float _inputPeak{0.f};
+
+  void drawTransferCurve(NativeDrawContext* nvg, Rect r, NVGcolor color);
+  void drawSpectrum(NativeDrawContext* nvg, Rect r, NVGcolor color);
+};
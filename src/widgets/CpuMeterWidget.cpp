@@ -0,0 +1,85 @@
+#include "CpuMeterWidget.h"
+#include <algorithm>
+#include <cstdio>
+
+using namespace ml;
+
+void CpuMeterWidget::beginUpdate()
+{
+  // Fade old counts so the histogram follows the current load
+  for (auto& count : _bins) count *= 0.9f;
+  for (auto& stage : _stageMicros) stage *= 0.9f;
+
+  if (++_worstAge > kWorstHoldUpdates)
+  {
+    _worstMicros = 0.f;
+    _worstAge = 0;
+  }
+}
+
+void CpuMeterWidget::addFrame(const TelemetryFrame& frame)
+{
+  int bin = static_cast<int>(frame.load() / kMaxLoad * kNumBins);
+  _bins[std::clamp(bin, 0, kNumBins - 1)] += 1.f;
+
+  for (int s = 0; s < kNumTelemetryStages; ++s)
+  {
+    _stageMicros[s] += 0.1f * frame.stageMicros[s];
+  }
+
+  if (frame.blockMicros > _worstMicros)
+  {
+    _worstMicros = frame.blockMicros;
+    _worstBudgetMicros = frame.budgetMicros;
+    _worstAge = 0;
+  }
+}
+
+void CpuMeterWidget::draw(ml::DrawContext dc)
+{
+  NativeDrawContext* nvg = getNativeContext(dc);
+  Rect bounds = getLocalBounds(dc, *this);
+
+  bool enabled = getBoolPropertyWithDefault("enabled", true);
+  if(!enabled) return;
+
+  auto color = getColorPropertyWithDefault("color", getColor(dc, "mark"));
+  float opacity = getFloatPropertyWithDefault("opacity", 1.0f);
+  auto barColor = multiplyAlpha(color, opacity);
+
+  // Histogram across the lower two thirds, one bar per load bin, scaled to the largest count
+  Rect histogram(bounds.left(), bounds.top() + bounds.height() / 3.f, bounds.width(), bounds.height() * 2.f / 3.f);
+  float maxCount = std::max(1.f, *std::max_element(_bins.begin(), _bins.end()));
+  float barWidth = histogram.width() / kNumBins;
+  nvgBeginPath(nvg);
+  for (int i = 0; i < kNumBins; ++i)
+  {
+    float h = histogram.height() * _bins[i] / maxCount;
+    nvgRect(nvg, histogram.left() + i * barWidth, histogram.bottom() - h, barWidth * 0.8f, h);
+  }
+  nvgFillColor(nvg, barColor);
+  nvgFill(nvg);
+
+  // Budget line at 100% load
+  nvgBeginPath(nvg);
+  float budgetX = histogram.left() + histogram.width() / kMaxLoad;
+  nvgMoveTo(nvg, budgetX, histogram.top());
+  nvgLineTo(nvg, budgetX, histogram.bottom());
+  nvgStrokeColor(nvg, multiplyAlpha(barColor, 0.5f));
+  nvgStrokeWidth(nvg, 1.0f);
+  nvgStroke(nvg);
+
+  // Worst block and stage shares in the top third
+  float totalStage = _stageMicros[kSaturationStage] + _stageMicros[kFilterStage] + _stageMicros[kMixStage];
+  auto share = [&](TelemetryStage s) { return totalStage > 0.f ? 100.f * _stageMicros[s] / totalStage : 0.f; };
+  char text[128];
+  std::snprintf(text, sizeof(text), "load %.0f%%  worst %.1f/%.0f us  sat %.0f%% flt %.0f%% mix %.0f%%",
+                100.f * getFloatPropertyWithDefault("load", 0.f), _worstMicros, _worstBudgetMicros, share(kSaturationStage), share(kFilterStage), share(kMixStage));
+
+  // d_din is loaded by the GUI in initializeResources()
+  nvgFontFace(nvg, "d_din");
+  nvgFontSize(nvg, bounds.height() / 3.f);
+  nvgTextAlign(nvg, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
+  nvgFillColor(nvg, barColor);
+  nvgText(nvg, bounds.left(), bounds.top() + bounds.height() / 6.f, text, nullptr);
+}
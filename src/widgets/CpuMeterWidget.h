@@ -0,0 +1,40 @@
+#pragma once
+
+#include "MLWidget.h"
+#include "Telemetry.h"
+#include <array>
+
+using namespace ml;
+
+// Live view of audio-thread load: a histogram of per-block load, the worst
+// block time of the last few seconds and the share of time spent per stage.
+// Fed from the GUI thread with frames drained from BlockTelemetry.
+class CpuMeterWidget : public Widget
+{
+public:
+  // Histogram bins cover 0 to kMaxLoad of the real-time budget; the last bin collects anything above
+  static constexpr int kNumBins = 25;
+  static constexpr float kMaxLoad = 1.25f;
+
+  CpuMeterWidget(WithValues p) : Widget(p) {}
+
+  // Call once per GUI update before adding that update's frames
+  void beginUpdate();
+  void addFrame(const TelemetryFrame& frame);
+
+  // Widget implementation
+  void draw(ml::DrawContext dc) override;
+
+private:
+  // Decaying block counts per load bin
+  std::array<float, kNumBins> _bins{};
+
+  // Worst block time and its budget, held for kWorstHoldUpdates updates
+  static constexpr int kWorstHoldUpdates = 90;
+  float _worstMicros{0.f};
+  float _worstBudgetMicros{0.f};
+  int _worstAge{0};
+
+  // Smoothed time per stage
+  std::array<float, kNumTelemetryStages> _stageMicros{};
+};